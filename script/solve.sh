@@ -0,0 +1,61 @@
+#!/bin/bash
+set -o pipefail -o noclobber -o nounset
+
+# Launches the cdcl variant whose literal and clause index widths fit the
+# instance, based on the counts declared in the DIMACS problem line (or the
+# snapshot header, for binary inputs produced by bin/cnfc). See src/types.h:
+# bin/cdcl-small uses 16-bit literals, bin/cdcl the default 32-bit widths,
+# and bin/cdcl-large 64-bit clause indexes.
+#
+# Usage: script/solve.sh [solver flags...] <cnf file>
+
+if [[ "$#" -lt 1 ]]; then
+    echo "Usage: $0 [solver flags...] <cnf file>" >&2
+    exit 1
+fi
+
+FILENAME="${!#}"
+if [[ ! -r "${FILENAME}" ]]; then
+    echo "Can't read input file: ${FILENAME}" >&2
+    exit 1
+fi
+
+# Thresholds, chosen with headroom: 16-bit literals top out at 32767
+# variables, and learned clauses grow the clause array well beyond what the
+# problem line declares, so we only use the small build for comfortably small
+# instances and switch to 64-bit clause indexes long before 2^32 elements.
+SMALL_MAX_VARS=$((2**15 - 1))
+SMALL_MAX_CLAUSES=$((2**20))
+LARGE_MIN_CLAUSES=$((2**26))
+
+LIT_BYTES=
+if [[ "$(head -c4 "${FILENAME}")" == "SCNF" ]]; then
+    # Binary snapshot: counts come from the header (see parse.h). Snapshots
+    # record their literal width, and only a build with a matching lit_t can
+    # load one.
+    LIT_BYTES=$(od -An -tu1 -j4 -N1 "${FILENAME}" | tr -d ' ')
+    NVARS=$(od -An -td8 -j8 -N8 "${FILENAME}" | tr -d ' ')
+    NCLAUSES=$(od -An -td8 -j16 -N8 "${FILENAME}" | tr -d ' ')
+else
+    read -r NVARS NCLAUSES < \
+        <(awk '/^p[ \t]+cnf/ {print $3, $4; exit}' "${FILENAME}")
+fi
+
+if [[ -z "${NVARS:-}" || -z "${NCLAUSES:-}" ]]; then
+    echo "No problem line found in ${FILENAME}" >&2
+    exit 1
+fi
+
+BINARY=cdcl
+if [[ "${NCLAUSES}" -ge "${LARGE_MIN_CLAUSES}" ]]; then
+    BINARY=cdcl-large
+elif [[ "${NVARS}" -le "${SMALL_MAX_VARS}" && \
+        "${NCLAUSES}" -le "${SMALL_MAX_CLAUSES}" && \
+        ( -z "${LIT_BYTES}" || "${LIT_BYTES}" -eq 2 ) ]]; then
+    BINARY=cdcl-small
+fi
+
+make "bin/${BINARY}" 1>&2
+if [[ "$?" != 0 ]]; then exit 1; fi
+
+exec "bin/${BINARY}" "$@"
@@ -0,0 +1,458 @@
+// A benchmark harness that times the parse and solve phases of the main
+// solvers (Algorithm C/D/L/W) over a set of DIMACS files, with warm-up and
+// repetition. Each measured run happens in a forked child so that solver
+// state, counters, and memory use are fresh every time and engines are free
+// to call exit() mid-solve the way they normally do; the child reports its
+// timings and counter totals over a pipe from an atexit handler, and the
+// parent collects peak RSS from wait4. Results go to stdout as CSV, one row
+// per engine/instance pair (median-solve-time rep), so a baseline is just a
+// redirected run:
+//
+//   bin/bench -s2 test/*.cnf > baseline.csv
+//
+// Compare mode (-b) re-runs the same measurements and reports the change in
+// solve time and propagation rate against the saved baseline, exiting
+// nonzero if any instance's solve time regressed by more than 10%.
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Standard headers used by the engines must be included here at top level so
+// their include guards keep them from being re-included inside the engine
+// namespaces below.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "counters.h"
+#include "flags.h"
+#include "heap.h"
+#include "logging.h"
+#include "timer.h"
+#include "types.h"
+#include "params.h"
+#include "process.h"
+
+// Each engine below is compiled into its own namespace so that their Cnf
+// structs, parse/solve functions, and params don't collide, exactly as in
+// portfolio.cc. main is renamed per engine so the entry points don't collide
+// with ours (we never call them).
+
+// The engines' real main functions rely on falling off the end of main, which
+// is only legal for a function actually named main.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wreturn-type"
+
+#define main cdcl_main
+namespace cdcl {
+#include "cdcl.cc"
+}
+#undef main
+// cdcl.cc defines clause-layout macros that we don't want leaking into the
+// other engines.
+#undef LIT0
+#undef LIT1
+#undef SIZE
+#undef WATCH0
+#undef WATCH1
+#undef PIN
+#undef LBD
+
+#define main dpll_main
+namespace dpll {
+#include "dpll.cc"
+}
+#undef main
+
+#define main look_main
+namespace look {
+#include "look.cc"
+}
+#undef main
+
+#define main walk_main
+namespace walk {
+#include "walk.cc"
+}
+#undef main
+
+#pragma GCC diagnostic pop
+
+// Definitions for flags the engines declare extern inside their namespaces.
+namespace cdcl { ::std::string FLAGS_dratfile = ""; }
+namespace walk { unsigned long FLAGS_seed = 0; }
+
+// What a child sends back to the parent over the report pipe. decisions
+// covers walk's flips too, since a flip is WalkSAT's unit of search work.
+struct BenchRecord {
+    int64_t parse_ns;
+    int64_t solve_ns;
+    uint64_t decisions;
+    uint64_t propagations;
+};
+
+// Child-side state for the atexit reporter. The solve clock is read by the
+// handler so that engines that exit() from inside solve (SAT_EXIT and
+// UNSAT_EXIT) still get a solve time attributed to them.
+static int g_report_fd = -1;
+static int64_t g_parse_ns = 0;
+static int64_t g_solve_ns = -1;
+static bool g_solve_started = false;
+static std::chrono::steady_clock::time_point g_solve_start;
+
+static int64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+static void report_at_exit() {
+    if (g_report_fd < 0) return;
+    BenchRecord r;
+    r.parse_ns = g_parse_ns;
+    r.solve_ns = g_solve_ns;
+    if (r.solve_ns < 0 && g_solve_started) {
+        r.solve_ns = elapsed_ns(g_solve_start);
+    }
+    r.decisions = Counters::singleton().total("decisions") +
+        Counters::singleton().total("flips");
+    r.propagations = Counters::singleton().total("propagations");
+    ssize_t unused = write(g_report_fd, &r, sizeof(r));
+    (void)unused;
+}
+
+// Runs one engine over one file in the current (child) process. Returns the
+// solver's verdict as an exit code; engines may also exit() on their own,
+// which the atexit handler above accounts for.
+static int run_engine(const std::string& engine, const char* filename) {
+    auto parse_start = std::chrono::steady_clock::now();
+    Processor p(filename);
+    bool sat = false;
+    bool can_refute = true;
+    if (engine == "cdcl") {
+        cdcl::Cnf* cc = cdcl::parse(&p);
+        g_parse_ns = elapsed_ns(parse_start);
+        g_solve_started = true;
+        g_solve_start = std::chrono::steady_clock::now();
+        sat = cc->clauses.empty() || cdcl::solve(cc);
+    } else if (engine == "dpll") {
+        dpll::Cnf dc = dpll::parse(&p);
+        g_parse_ns = elapsed_ns(parse_start);
+        g_solve_started = true;
+        g_solve_start = std::chrono::steady_clock::now();
+        sat = dc.start.empty() || dpll::solve(&dc);
+    } else if (engine == "look") {
+        look::Cnf lc = look::parse(&p);
+        g_parse_ns = elapsed_ns(parse_start);
+        g_solve_started = true;
+        g_solve_start = std::chrono::steady_clock::now();
+        sat = look::solve(&lc);
+    } else if (engine == "walk") {
+        walk::Cnf wc = walk::parse(&p);
+        g_parse_ns = elapsed_ns(parse_start);
+        g_solve_started = true;
+        g_solve_start = std::chrono::steady_clock::now();
+        sat = wc.clause_storage.empty() || walk::solve(&wc);
+        can_refute = false;  // WalkSAT can't prove unsatisfiability.
+    } else {
+        CHECK(false) << "Unknown engine: " << engine;
+    }
+    g_solve_ns = elapsed_ns(g_solve_start);
+    if (sat) return SATISFIABLE;
+    return can_refute ? UNSATISFIABLE : UNKNOWN;
+}
+
+// One fork/measure cycle. status is "sat", "unsat", "unknown", "timeout", or
+// "error"; rec is only valid if got_record is set.
+struct Outcome {
+    bool got_record;
+    BenchRecord rec;
+    std::string status;
+    long rss_kb;
+};
+
+static Outcome run_once(const std::string& engine, const char* filename,
+                        unsigned int timeout_secs) {
+    Outcome out;
+    out.got_record = false;
+    out.rss_kb = 0;
+    int fds[2];
+    CHECK(pipe(fds) == 0) << "pipe() failed";
+    pid_t pid = fork();
+    CHECK(pid >= 0) << "fork() failed";
+    if (pid == 0) {
+        close(fds[0]);
+        g_report_fd = fds[1];
+        // Engine chatter (including the satisfying assignment from SAT_EXIT)
+        // would corrupt our CSV, so silence the child's stdout.
+        if (freopen("/dev/null", "w", stdout) == nullptr) _exit(1);
+        FLAGS_counters = true;
+        // Touch the singleton before registering the reporter so the counter
+        // registry isn't destroyed before the atexit handler reads it (same
+        // trick as init_counters).
+        Counters::singleton();
+        std::atexit(report_at_exit);
+        if (timeout_secs > 0) alarm(timeout_secs);
+        exit(run_engine(engine, filename));
+    }
+    close(fds[1]);
+    size_t got = 0;
+    char* buf = reinterpret_cast<char*>(&out.rec);
+    while (got < sizeof(out.rec)) {
+        ssize_t n = read(fds[0], buf + got, sizeof(out.rec) - got);
+        if (n <= 0) break;
+        got += n;
+    }
+    close(fds[0]);
+    out.got_record = (got == sizeof(out.rec));
+    int status = 0;
+    struct rusage ru;
+    memset(&ru, 0, sizeof(ru));
+    CHECK(wait4(pid, &status, 0, &ru) == pid) << "wait4() failed";
+    out.rss_kb = ru.ru_maxrss;
+    if (WIFSIGNALED(status)) {
+        out.status = WTERMSIG(status) == SIGALRM ? "timeout" : "error";
+    } else if (WEXITSTATUS(status) == SATISFIABLE) {
+        out.status = "sat";
+    } else if (WEXITSTATUS(status) == UNSATISFIABLE) {
+        out.status = "unsat";
+    } else if (WEXITSTATUS(status) == UNKNOWN) {
+        out.status = "unknown";
+    } else {
+        out.status = "error";
+    }
+    return out;
+}
+
+// A finished CSV row, also the unit of baseline comparison.
+struct BenchRow {
+    std::string status;
+    double parse_ms;
+    double solve_ms;
+    uint64_t decisions;
+    uint64_t propagations;
+    double decisions_per_sec;
+    double propagations_per_sec;
+    long rss_kb;
+};
+
+static const char kCsvHeader[] =
+    "engine,instance,status,parse_ms,solve_ms,decisions,propagations,"
+    "decisions_per_sec,propagations_per_sec,peak_rss_kb";
+
+// Loads a baseline CSV previously written by this program into a map keyed
+// by "engine,instance".
+static std::map<std::string, BenchRow> load_baseline(const char* filename) {
+    std::map<std::string, BenchRow> baseline;
+    std::ifstream in(filename);
+    CHECK(in.good()) << "Can't read baseline file: " << filename;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line == kCsvHeader) continue;
+        std::istringstream iss(line);
+        std::string engine, instance, field;
+        BenchRow row;
+        std::getline(iss, engine, ',');
+        std::getline(iss, instance, ',');
+        std::getline(iss, row.status, ',');
+        std::getline(iss, field, ','); row.parse_ms = atof(field.c_str());
+        std::getline(iss, field, ','); row.solve_ms = atof(field.c_str());
+        std::getline(iss, field, ',');
+        row.decisions = strtoull(field.c_str(), NULL, 10);
+        std::getline(iss, field, ',');
+        row.propagations = strtoull(field.c_str(), NULL, 10);
+        std::getline(iss, field, ',');
+        row.decisions_per_sec = atof(field.c_str());
+        std::getline(iss, field, ',');
+        row.propagations_per_sec = atof(field.c_str());
+        std::getline(iss, field, ','); row.rss_kb = atol(field.c_str());
+        baseline[engine + "," + instance] = row;
+    }
+    return baseline;
+}
+
+static double pct_change(double baseline, double current) {
+    if (baseline == 0) return 0;
+    return 100.0 * (current - baseline) / baseline;
+}
+
+int main(int argc, char** argv) {
+    std::string engines = "cdcl,dpll,look,walk";
+    int reps = 3;
+    int warmups = 1;
+    unsigned int timeout_secs = 10;
+    const char* baseline_file = nullptr;
+
+    int c;
+    while ((c = getopt(argc, argv, "e:r:w:t:s:p:b:h")) != -1) {
+        switch (c) {
+        case 'e': engines = optarg; break;
+        case 'r': reps = atoi(optarg); break;
+        case 'w': warmups = atoi(optarg); break;
+        case 't': timeout_secs = strtoul(optarg, NULL, 0); break;
+        case 's':
+            FLAGS_seed = strtoul(optarg, NULL, 0);
+            CHECK(FLAGS_seed <= std::numeric_limits<unsigned int>::max())
+                << "Seed " << FLAGS_seed << " must be between 0 and "
+                << std::numeric_limits<unsigned int>::max();
+            break;
+        case 'p':
+            FLAGS_params = optarg;
+            Params::singleton().parse(FLAGS_params);
+            break;
+        case 'b': baseline_file = optarg; break;
+        case 'h':
+            PRINT << "Usage: " << argv[0] << " [OPTIONS]... FILE..."
+                  << std::endl << std::endl;
+            PRINT << "Benchmarks solver parse/solve phases over the given "
+                  << "DIMACS files, writing CSV" << std::endl
+                  << "results to stdout. Progress and comparisons go to "
+                  << "stderr." << std::endl << std::endl;
+            PRINT << "OPTIONS include:" << std::endl << std::endl;
+            PRINT << "  -eLIST Comma-separated engines to run. Default: "
+                  << "cdcl,dpll,look,walk" << std::endl << std::endl;
+            PRINT << "  -rN    Measured repetitions per instance. The rep "
+                  << "with median solve time is" << std::endl
+                  << "         reported. Default: 3" << std::endl << std::endl;
+            PRINT << "  -wN    Warm-up (discarded) repetitions per instance. "
+                  << "Default: 1" << std::endl << std::endl;
+            PRINT << "  -tN    Per-run timeout in seconds, 0 to disable. "
+                  << "Default: 10" << std::endl << std::endl;
+            PRINT << "  -sN    Set the random seed to N" << std::endl
+                  << std::endl;
+            PRINT << "  -pP    Set solver params, as for the solver binaries"
+                  << std::endl << std::endl;
+            PRINT << "  -bF    Compare against baseline CSV file F and exit "
+                  << "nonzero if any" << std::endl
+                  << "         instance's solve time regressed more than 10%"
+                  << std::endl << std::endl;
+            PRINT << "  -h     Display this message" << std::endl;
+            exit(0);
+        default:
+            std::cerr << "Usage: " << argv[0] << " [OPTIONS]... FILE..."
+                      << std::endl;
+            exit(1);
+        }
+    }
+    CHECK(optind < argc) << "No input files given. Try " << argv[0] << " -h";
+    CHECK(reps >= 1) << "Need at least one measured rep.";
+    CHECK(warmups >= 0) << "Warm-up count can't be negative.";
+    walk::FLAGS_seed = FLAGS_seed;
+
+    std::map<std::string, BenchRow> baseline;
+    if (baseline_file != nullptr) baseline = load_baseline(baseline_file);
+
+    std::vector<std::string> engine_list;
+    std::istringstream ess(engines);
+    std::string engine;
+    while (std::getline(ess, engine, ',')) {
+        CHECK(engine == "cdcl" || engine == "dpll" || engine == "look" ||
+              engine == "walk") << "Unknown engine: " << engine;
+        engine_list.push_back(engine);
+    }
+
+    PRINT << kCsvHeader << std::endl;
+    int regressions = 0;
+    for (const std::string& eng : engine_list) {
+        for (int i = optind; i < argc; ++i) {
+            const char* filename = argv[i];
+            std::cerr << "c [bench] " << eng << " " << filename << std::endl;
+            for (int w = 0; w < warmups; ++w) {
+                run_once(eng, filename, timeout_secs);
+            }
+            std::vector<Outcome> runs;
+            for (int r = 0; r < reps; ++r) {
+                runs.push_back(run_once(eng, filename, timeout_secs));
+            }
+
+            // Report the rep with median solve time; peak RSS is the max
+            // across reps. A rep that timed out or died poisons the row,
+            // since its timings don't mean anything.
+            BenchRow row;
+            row.status = runs[0].status;
+            row.parse_ms = row.solve_ms = 0;
+            row.decisions = row.propagations = 0;
+            row.decisions_per_sec = row.propagations_per_sec = 0;
+            row.rss_kb = 0;
+            bool ok = true;
+            for (const Outcome& run : runs) {
+                row.rss_kb = std::max(row.rss_kb, run.rss_kb);
+                if (!run.got_record || run.status == "timeout" ||
+                    run.status == "error") {
+                    row.status = run.status;
+                    ok = false;
+                }
+            }
+            if (ok) {
+                std::vector<Outcome> sorted = runs;
+                std::sort(sorted.begin(), sorted.end(),
+                          [](const Outcome& a, const Outcome& b) {
+                              return a.rec.solve_ns < b.rec.solve_ns;
+                          });
+                const Outcome& med = sorted[sorted.size() / 2];
+                row.status = med.status;
+                row.parse_ms = med.rec.parse_ns / 1e6;
+                row.solve_ms = med.rec.solve_ns / 1e6;
+                row.decisions = med.rec.decisions;
+                row.propagations = med.rec.propagations;
+                if (med.rec.solve_ns > 0) {
+                    row.decisions_per_sec =
+                        med.rec.decisions * 1e9 / med.rec.solve_ns;
+                    row.propagations_per_sec =
+                        med.rec.propagations * 1e9 / med.rec.solve_ns;
+                }
+            }
+
+            PRINT << eng << "," << filename << "," << row.status << ","
+                  << row.parse_ms << "," << row.solve_ms << ","
+                  << row.decisions << "," << row.propagations << ","
+                  << row.decisions_per_sec << ","
+                  << row.propagations_per_sec << "," << row.rss_kb
+                  << std::endl;
+
+            if (baseline_file == nullptr) continue;
+            auto itr = baseline.find(eng + "," + std::string(filename));
+            if (itr == baseline.end()) continue;
+            const BenchRow& base = itr->second;
+            if (!ok || base.status != row.status) {
+                std::cerr << "c [bench]   status " << base.status << " -> "
+                          << row.status << std::endl;
+                continue;
+            }
+            double solve_delta = pct_change(base.solve_ms, row.solve_ms);
+            std::cerr << "c [bench]   solve_ms " << base.solve_ms << " -> "
+                      << row.solve_ms << " (" << (solve_delta >= 0 ? "+" : "")
+                      << solve_delta << "%), props/sec "
+                      << base.propagations_per_sec << " -> "
+                      << row.propagations_per_sec << ", rss_kb "
+                      << base.rss_kb << " -> " << row.rss_kb << std::endl;
+            // Ignore sub-5ms solves when flagging regressions; at that scale
+            // the deltas are mostly scheduler noise.
+            if (solve_delta > 10.0 && row.solve_ms >= 5.0) {
+                std::cerr << "c [bench]   REGRESSION" << std::endl;
+                ++regressions;
+            }
+        }
+    }
+
+    if (baseline_file != nullptr) {
+        std::cerr << "c [bench] " << regressions << " regression(s) vs "
+                  << baseline_file << std::endl;
+        if (regressions > 0) return 1;
+    }
+    return 0;
+}
@@ -10,18 +10,29 @@
 //   - Ex. 271: Subsumption of immediate predecessor learned clauses
 //
 // The restart scheme we use is almost exactly as Knuth describes. The clause
-// purging scheme we use is a little different: although we do execute "full
-// runs" before each lemma database reduction, we don't use extra storage in
-// the clause array to track clause activity and a usefulness metric derived
-// from literal block distance (LBD). Instead, we just compute LBD directly
-// and use it to gauge clause usefulness during purging.
-
+// purging scheme we use is a little different: we don't use extra storage in
+// the clause array to track clause activity. Instead, each lemma's header
+// stores its literal block distance (LBD), computed when the lemma is learned
+// and refreshed whenever the lemma is re-used as a reason during resolution,
+// and we use that to gauge clause usefulness during purging. Since LBD is
+// always available, a purge can run as soon as the lemma count exceeds its
+// cap -- no "full run" assigning a level to every variable is needed first.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <ctime>
 #include <cstdlib>
 #include <functional>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <vector>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 #include "counters.h"
 #include "flags.h"
 #include "heap.h"
@@ -36,12 +47,12 @@ extern std::string FLAGS_dratfile;
 // All clauses are stored linearly in one big array using elements of this union
 // type. The layout for each clause is:
 //
-//     [ptr_1][ptr_0][size][lit_0][lit_1]...[lit_n]
+//     [scratch_1][scratch_0][size][lit_0][lit_1]...[lit_n]
 //
-// The first two ptr elements are watchlist pointers for the second and first
-// literals in the clause, respectively. The size element stores the length of
-// the clause, and the rest of the storage for the clause consists of the
-// literals themselves.
+// The two scratch elements are only used during lemma database reductions
+// (see PIN/LBD below); watchlists live in separate per-literal watcher
+// vectors. The size element stores the length of the clause, and the rest of
+// the storage for the clause consists of the literals themselves.
 union clause_elem_t {
     lit_t lit;
     clause_t size;
@@ -53,19 +64,154 @@ union clause_elem_t {
 #define LIT1(c) clauses[c+1].lit
 #define LIT0(c) clauses[c].lit
 #define SIZE(c) clauses[c-1].size
-#define WATCH0(c) clauses[c-2].ptr
-#define WATCH1(c) clauses[c-3].ptr
+#define SCRATCH0(c) clauses[c-2].ptr
+#define SCRATCH1(c) clauses[c-3].ptr
 
-// During a lemma database reduction, we'll temporarily re-purpose some of the
-// watchlist pointer storage to tag clauses that we want to keep and to store
-// the literal block distance of the clause.
+// During a lemma database reduction, we'll re-purpose the scratch storage in
+// each clause header to tag clauses that we want to keep and to store the
+// literal block distance of the clause.
 #define PIN(c) clauses[c-2].lit
 #define LBD(c) clauses[c-3].lit
 
 // Size of the header for each clause in the clause array, consisting of two
-// watchlist pointers plus size info.
+// scratch elements plus size info.
 constexpr clause_t kHeaderSize = 3;
 
+// Chunked arena backing the clause array. Indexing works exactly like the
+// flat vector it replaces -- clause_t offsets stay valid everywhere -- but
+// storage grows by appending fixed-size chunks, so installing a lemma never
+// relocates clauses already in place. With a flat vector, a push_back during
+// learn_clause could reallocate and copy the entire multi-gigabyte database
+// in the middle of the search; here growth is a single chunk allocation.
+//
+// Chunks are cache-line-aligned and a power of two in size, and start_clause
+// pads with tombstoned literals (which clause iteration already skips) so
+// that every clause's first literal begins a cache line and no clause
+// straddles a chunk boundary. The C4 literal scan therefore touches only
+// full lines of literal data, and the vector loads in find_non_false can
+// assume each clause's literals are contiguous in memory.
+class ClauseArena {
+  public:
+    // 2^18 elements = 1MiB chunks.
+    static constexpr size_t kChunkBits = 18;
+    static constexpr size_t kChunkSize = size_t(1) << kChunkBits;
+    static constexpr size_t kChunkMask = kChunkSize - 1;
+    // Elements per cache line.
+    static constexpr size_t kLineElems = 64 / sizeof(clause_elem_t);
+
+    ClauseArena() : size_(0) {}
+    ClauseArena(const ClauseArena&) = delete;
+    ClauseArena& operator=(const ClauseArena&) = delete;
+    ~ClauseArena() { for (clause_elem_t* ch : chunks_) free(ch); }
+
+    inline clause_elem_t& operator[](size_t i) {
+        return chunks_[i >> kChunkBits][i & kChunkMask];
+    }
+    inline const clause_elem_t& operator[](size_t i) const {
+        return chunks_[i >> kChunkBits][i & kChunkMask];
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    void push_back(clause_elem_t e) {
+        if (size_ == chunks_.size() << kChunkBits) add_chunk();
+        (*this)[size_++] = e;
+    }
+
+    // Shrinks the arena. Chunks are kept around for reuse; the next
+    // start_clause fills them back up.
+    void resize(size_t n) {
+        CHECK(n <= size_) << "ClauseArena can only shrink";
+        size_ = n;
+    }
+
+    // Returns the first index >= next at which a clause with nlits literals
+    // can start so that its first literal is cache-line-aligned and the
+    // whole clause fits in one chunk. next and the result both address the
+    // clause's first literal; the header occupies the preceding kHeaderSize
+    // elements.
+    clause_t fit(clause_t next, clause_t nlits) const {
+        CHECK(nlits <= kChunkSize) << "Clause too long for one arena chunk";
+        next = (next + kLineElems - 1) & ~(kLineElems - 1);
+        if ((next & kChunkMask) + nlits > kChunkSize) {
+            // Jump to the next chunk, leaving one line for the header.
+            next = ((next >> kChunkBits) + 1) << kChunkBits;
+        }
+        return next;
+    }
+
+    // Appends a fresh header for a clause with nlits literals, padding with
+    // tombstones per fit() above, and returns the index of the clause (i.e.,
+    // of its first literal). The caller pushes exactly nlits literals next.
+    clause_t start_clause(clause_t nlits) {
+        clause_t lc = fit(size_ + kHeaderSize, nlits);
+        pad_to(lc - kHeaderSize);
+        push_back({.ptr = clause_nil});  // SCRATCH1
+        push_back({.ptr = clause_nil});  // SCRATCH0
+        push_back({.size = nlits});      // SIZE
+        return lc;
+    }
+
+    // In-place variant of start_clause for compaction: places a clause with
+    // nlits literals at or after candidate index next, tombstoning any
+    // elements skipped over, and returns the chosen index. Only writes to
+    // elements below the current size.
+    clause_t place(clause_t next, clause_t nlits) {
+        clause_t lc = fit(next, nlits);
+        for (clause_t i = next - kHeaderSize; i < lc - kHeaderSize; ++i) {
+            (*this)[i].lit = lit_nil;
+        }
+        return lc;
+    }
+
+  private:
+    void add_chunk() {
+        void* p = nullptr;
+        CHECK(posix_memalign(&p, 64, kChunkSize * sizeof(clause_elem_t)) == 0)
+            << "Out of memory allocating clause storage";
+        chunks_.push_back(static_cast<clause_elem_t*>(p));
+    }
+
+    void pad_to(clause_t n) {
+        while (size_ < n) push_back({.lit = lit_nil});
+    }
+
+    std::vector<clause_elem_t*> chunks_;
+    size_t size_;
+};
+
+// An entry in a literal's watchlist. Each watched clause is paired with a
+// cached "blocking literal": some other literal from the clause that was true
+// the last time we touched the entry. If the blocking literal is still true
+// during propagation, the clause can't force anything and we can skip it
+// without touching clause memory at all.
+struct Watcher {
+    clause_t c;
+    lit_t blit;
+};
+
+// An entry in a literal's binary implication list, like the bimp structure
+// used by the lookahead solver: for a binary clause (x y), setting -x true
+// directly forces y. We keep the clause index alongside the forced literal so
+// it can be recorded as a reason for resolution.
+struct Bimp {
+    lit_t l;
+    clause_t c;
+};
+
+DEFINE_PARAM(telemetry_interval, 0,
+             "If non-zero, print a compact status line every N conflicts so "
+             "long runs can be monitored (and stuck runs preempted) without "
+             "waiting for the final counter dump. Driven by a conflict-count "
+             "check in the search loop, so it costs nothing when disabled.");
+
+// Hot-path phase timers (see timer.h); only active with -t.
+DEFINE_PHASE(propagation);
+DEFINE_PHASE(conflict_analysis);
+DEFINE_PHASE(reduce_db);
+DEFINE_PHASE(vivification);
+
 DEFINE_PARAM(min_purged_clause_size, 4,
              "Only clauses with at least this many literals are candidates "
              "for removal during a lemma database reduction.");
@@ -79,6 +225,15 @@ DEFINE_PARAM(reduce_db_fraction, 0.55,
              "A number between 0 and 1, the fraction of lemmas we attempt to "
              "retain during a lemma database reduction.");
 
+DEFINE_PARAM(vivify_max_lbd, 4,
+             "Lemmas with stored LBD at most this value are candidates for "
+             "vivification, a pass that tries to shorten surviving lemmas "
+             "after a lemma database reduction. 0 disables vivification.");
+
+DEFINE_PARAM(vivify_budget, 100000,
+             "Maximum number of literals a single vivification pass may add "
+             "to the trail while probing clauses.");
+
 DEFINE_PARAM(partial_restart_prob, 0.0,
              "When restarting, probability that we attempt to find a higher "
              "non-zero level to backjump to.");
@@ -106,10 +261,6 @@ DEFINE_PARAM(restart_sensitivity, 0.19,
              "Knuth's ψ parameter, a value between 0 and 1. Increasing this "
              "parameter increases the likelihood we restart.");
 
-DEFINE_PARAM(sorted_watchlists, 0,
-             "If set to 1, watchlists are kept in increasing order of clause "
-             "length");
-
 // Optimization described in Exercise 257 (Redundant literal detection).
 DEFINE_PARAM(remove_redundant_literals, 1,
              "If set to 1, redundant literals in learned clauses are removed.");
@@ -132,6 +283,206 @@ DEFINE_PARAM(predecessor_subsumption, 1,
              "If set to 1, check the previous clause we learned when learning "
              "a new clause to see if the new clause subsumes the older one.");
 
+DEFINE_PARAM(workers, 1,
+             "Number of CDCL search threads to run concurrently. Each worker "
+             "gets its own shuffled heap and perturbed restart sensitivity, "
+             "and workers exchange short lemmas through a lock-free buffer.");
+
+DEFINE_PARAM(share_size_limit, 8,
+             "In multi-worker mode, only lemmas with at most this many "
+             "literals are offered to other workers.");
+
+// A bounded, lock-free exchange buffer used to share short lemmas between
+// workers in multi-worker mode. Writers claim a slot by bumping head and
+// publish with a seqlock-style per-slot sequence number; each reader keeps a
+// private cursor and skips any slot that was mid-write or overwritten by the
+// time it got there. Slow readers lose clauses, but writers never block.
+struct ClauseExchange {
+    static constexpr size_t kSlots = 4096;
+    static constexpr uint32_t kMaxLits = 8;
+
+    // The slot for position p holds seq 2p+1 while being written and 2p+2
+    // once the write is complete. All slots start at seq 0.
+    struct Slot {
+        std::atomic<uint64_t> seq{0};
+        uint32_t owner;
+        uint32_t size;
+        lit_t lits[kMaxLits];
+    };
+
+    std::atomic<uint64_t> head{0};
+    Slot slots[kSlots];
+
+    void publish(uint32_t owner, const lit_t* lits, uint32_t size) {
+        uint64_t p = head.fetch_add(1, std::memory_order_relaxed);
+        Slot& s = slots[p % kSlots];
+        s.seq.store(2*p+1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.owner = owner;
+        s.size = size;
+        for (uint32_t i = 0; i < size; ++i) { s.lits[i] = lits[i]; }
+        s.seq.store(2*p+2, std::memory_order_release);
+    }
+
+    // Copies the next available clause not published by owner into out,
+    // advancing *cursor past everything consumed or skipped. Returns false
+    // once the reader has caught up with head.
+    bool consume(uint32_t owner, uint64_t* cursor, lit_t* out,
+                 uint32_t* size) {
+        uint64_t h = head.load(std::memory_order_acquire);
+        while (*cursor < h) {
+            uint64_t p = *cursor;
+            // If we've fallen more than a full ring behind, skip ahead to the
+            // oldest slot that could still be intact.
+            if (h > kSlots && p < h - kSlots) p = h - kSlots;
+            Slot& s = slots[p % kSlots];
+            uint64_t s1 = s.seq.load(std::memory_order_acquire);
+            if (s1 != 2*p+2) { *cursor = p + 1; continue; }
+            uint32_t own = s.owner;
+            uint32_t sz = s.size;
+            if (sz > kMaxLits) { *cursor = p + 1; continue; }
+            for (uint32_t i = 0; i < sz; ++i) { out[i] = s.lits[i]; }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.seq.load(std::memory_order_relaxed) != s1) {
+                *cursor = p + 1;
+                continue;
+            }
+            *cursor = p + 1;
+            if (own == owner) continue;
+            *size = sz;
+            return true;
+        }
+        return false;
+    }
+};
+
+DEFINE_PARAM(binary_drat, 1,
+             "If 1, DRAT proofs are written in the compact binary format "
+             "understood by drat-trim. If 0, plain text DRAT is written.");
+
+DEFINE_PARAM(drat_flush_threshold, 1 << 22,
+             "Number of buffered DRAT proof bytes that triggers a flush to "
+             "disk by the background writer thread.");
+
+// Streams DRAT proof records to a file. Records are staged in a large
+// in-memory buffer and flushed by a background thread, so the search never
+// stalls on disk writes. Supports both the plain text format and the binary
+// format (controlled by PARAM_binary_drat): in binary mode each record is an
+// 'a' (addition) or 'd' (deletion) byte followed by variable-length encoded
+// literals and a terminating zero byte, with literal l encoded as the varint
+// of 2*|l| + [l < 0].
+struct ProofWriter {
+    explicit ProofWriter(const char* path) : out(fopen(path, "w")) {
+        CHECK(out != nullptr) << "Failed to open dratfile: " << path;
+        writer = std::thread([this]{ this->run(); });
+    }
+
+    ~ProofWriter() {
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            done = true;
+        }
+        cv.notify_one();
+        writer.join();
+        fclose(out);
+    }
+
+    // Begins an addition (deletion = false) or deletion (deletion = true)
+    // record. Stage the record's literals with lit(), then commit it to the
+    // shared buffer with end().
+    void start(bool deletion) {
+        rec.clear();
+        if (PARAM_binary_drat == 1) {
+            rec.push_back(deletion ? 'd' : 'a');
+        } else if (deletion) {
+            rec.push_back('d');
+            rec.push_back(' ');
+        }
+    }
+
+    void lit(lit_t l) {
+        if (PARAM_binary_drat == 1) {
+            uint64_t u = 2 * static_cast<uint64_t>(l < 0 ? -l : l) +
+                (l < 0 ? 1 : 0);
+            while (u >= 0x80) {
+                rec.push_back(static_cast<char>(u & 0x7f) | 0x80);
+                u >>= 7;
+            }
+            rec.push_back(static_cast<char>(u));
+        } else {
+            char tmp[16];
+            int n = snprintf(tmp, sizeof(tmp), "%d ", static_cast<int>(l));
+            rec.insert(rec.end(), tmp, tmp + n);
+        }
+    }
+
+    void end() {
+        if (PARAM_binary_drat == 1) {
+            rec.push_back(0);
+        } else {
+            rec.push_back('0');
+            rec.push_back('\n');
+        }
+        bool flush = false;
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            buf.insert(buf.end(), rec.begin(), rec.end());
+            flush = buf.size() >= size_t(PARAM_drat_flush_threshold);
+        }
+        if (flush) cv.notify_one();
+    }
+
+    // Blocks until everything committed so far is on disk. Must be called
+    // before reporting UNSAT: the solver leaves through exit(), which skips
+    // destructors, so nobody else will drain the buffer.
+    void flush() {
+        std::unique_lock<std::mutex> lock(mu);
+        flush_now = true;
+        cv.notify_one();
+        cv_idle.wait(lock, [this]{
+            return buf.empty() && !writing && !flush_now;
+        });
+        fflush(out);
+    }
+
+private:
+    // Background writer: swaps the staging buffer out under the lock, then
+    // does the actual disk write with the lock dropped.
+    void run() {
+        std::unique_lock<std::mutex> lock(mu);
+        while (true) {
+            cv.wait(lock, [this]{
+                return done || flush_now ||
+                    buf.size() >= size_t(PARAM_drat_flush_threshold);
+            });
+            while (!buf.empty()) {
+                std::swap(buf, flushing);
+                writing = true;
+                lock.unlock();
+                fwrite(flushing.data(), 1, flushing.size(), out);
+                flushing.clear();
+                lock.lock();
+                writing = false;
+            }
+            flush_now = false;
+            cv_idle.notify_all();
+            if (done) return;
+        }
+    }
+
+    FILE* out;
+    std::vector<char> rec;       // Staging area for the current record.
+    std::vector<char> buf;       // Committed records awaiting a flush.
+    std::vector<char> flushing;  // Writer-thread-private flush buffer.
+    std::mutex mu;
+    std::condition_variable cv;
+    std::condition_variable cv_idle;
+    std::thread writer;
+    bool done = false;
+    bool writing = false;
+    bool flush_now = false;
+};
+
 // Possible states for a literal during search.
 enum State {
     UNSET = 0,
@@ -139,6 +490,31 @@ enum State {
     TRUE = 2,
 };
 
+DEFINE_PARAM(chrono_backtrack_threshold, 0,
+             "If non-zero, backjumps that would unwind more than this many "
+             "levels backtrack chronologically instead: step back a single "
+             "level and force the asserting literal there, preserving the "
+             "propagation work on the trail. 0 disables.");
+
+DEFINE_PARAM(restart_policy, 0,
+             "Restart heuristic: 0 = Knuth's agility measure gated by "
+             "reluctant doubling, 1 = glucose-style comparison of short- and "
+             "long-term exponential moving averages of learned clause LBDs, "
+             "with trail-size-based blocking.");
+
+DEFINE_PARAM(ema_restart_threshold, 1.25,
+             "With restart_policy=1, restart when the short-term LBD average "
+             "exceeds this multiple of the long-term average.");
+
+DEFINE_PARAM(ema_restart_block, 1.4,
+             "With restart_policy=1, hold off restarting while the trail is "
+             "more than this multiple of its long-term average size, since a "
+             "full trail suggests we're close to a satisfying assignment.");
+
+DEFINE_PARAM(ema_restart_min_conflicts, 50,
+             "With restart_policy=1, the minimum number of conflicts between "
+             "restarts.");
+
 // Knuth's restart heuristic based on Armin Biere's agility measure. Essentially
 // computes a moving average called "agility" measuring how often literals are
 // assigned values that disagree with their previous values. A "reluctant
@@ -186,6 +562,54 @@ struct restart_oracle {
     float psi;
 };
 
+// Glucose-style restart heuristic: tracks a short-term and a long-term
+// exponential moving average of learned clause LBDs. When recent lemmas are
+// much worse (higher LBD) than the long-term norm, the current search region
+// probably isn't productive and we restart. Restarts are blocked while the
+// trail is much fuller than its long-term average, since a nearly complete
+// trail suggests we're close to a satisfying assignment that a restart would
+// throw away. Selected with -prestart_policy=1.
+struct ema_restart_oracle {
+    ema_restart_oracle() : fast(0), slow(0), trail_avg(0), conflicts(0) {}
+
+    // Called once per learned clause with the clause's LBD (computed at learn
+    // time, the same value reduce_db reads back out of the clause header) and
+    // the size of the trail at conflict time.
+    void learned(lit_t lbd, size_t trail_size) {
+        if (slow == 0) {  // First sample primes the averages.
+            fast = slow = lbd;
+            trail_avg = trail_size;
+        }
+        ++conflicts;
+        fast += kFastAlpha * (lbd - fast);
+        slow += kSlowAlpha * (lbd - slow);
+        trail_avg += kSlowAlpha * (trail_size - trail_avg);
+        if (conflicts >= PARAM_ema_restart_min_conflicts &&
+            trail_size > PARAM_ema_restart_block * trail_avg) {
+            conflicts = 0;
+            INC(blocked_restarts);
+        }
+    }
+
+    // Same interface as restart_oracle::should_restart: called in step C5,
+    // true means restart now. A true return resets the conflict gate, so a
+    // caller that asks again before the next conflict gets a false.
+    bool should_restart() {
+        if (conflicts < PARAM_ema_restart_min_conflicts) return false;
+        if (fast <= PARAM_ema_restart_threshold * slow) return false;
+        conflicts = 0;
+        return true;
+    }
+
+    // Smoothing factors for the short- and long-term averages; the trail
+    // average uses the long-term factor.
+    static constexpr double kFastAlpha = 1.0 / 32;
+    static constexpr double kSlowAlpha = 1.0 / 4096;
+
+    double fast, slow, trail_avg;
+    uint64_t conflicts;  // Conflicts since the last restart or block.
+};
+
 // Flips a coin that lands on heads with probability p. Return true iff heads.
 static bool flip(float p) {
     return static_cast<float>(rand())/RAND_MAX <= p;
@@ -200,12 +624,13 @@ struct Cnf {
     // Number of variables in the problem. [1, ..., nvars] are valid variables.
     size_t nvars;
 
-    // Array of all clauses. Consists of both clauses in the original formula
+    // Arena of all clauses. Consists of both clauses in the original formula
     // and lemmas learned by CDCL. All learned lemmas appear after original
     // clauses. The comment above clause_elem_t describes the layout. Clauses
-    // end with zero or more tombstoned literals which are all lit_nil. Unit
-    // clauses don't have WATCH0/WATCH1 set.
-    std::vector<clause_elem_t> clauses;
+    // end with zero or more tombstoned literals which are all lit_nil;
+    // tombstones also pad each clause to a cache line boundary (see
+    // ClauseArena above).
+    ClauseArena clauses;
 
     // The current value of a variable: either TRUE, FALSE, or UNSET.
     std::vector<State> val;
@@ -254,13 +679,19 @@ struct Cnf {
     // no such clause exists because the variable was part of a decision step.
     std::vector<clause_t> reason;
 
-    // Watchlists map a literal to the first clause in that literal's sequence
-    // of watched clauses. Each subsequent clause in the literal's watchlist can
-    // be found by following WATCH0/WATCH1 pointers, depending on whether the
-    // literal in question is in LIT0/LIT1, respectively. See the implementation
-    // of watchlist_debug_string for an example.
-    std::vector<clause_t> watch_storage;
-    clause_t* watch;
+    // Watchlists map a literal to a flat vector of watcher entries, one per
+    // clause watching that literal. Entries carry a cached blocking literal
+    // so that most propagation steps are resolved from a sequential scan of
+    // the vector without loading the clause itself.
+    std::vector<std::vector<Watcher>> watch_storage;
+    std::vector<Watcher>* watch;
+
+    // Binary implication lists. bimp[l] holds an entry for every binary
+    // clause that directly forces another literal once l is true. Binary
+    // clauses are registered here instead of in the watchlists, so binary
+    // propagation is a flat array walk with no clause memory access.
+    std::vector<std::vector<Bimp>> bimp_storage;
+    std::vector<Bimp>* bimp;
 
     // Temp storage for the learned clause, re-used each epoch.
     std::vector<lit_t> b;
@@ -277,6 +708,17 @@ struct Cnf {
     // (mod 3), which is why we bump by 3 each time.
     unsigned long epoch;
 
+    // Scratch used to count distinct levels when computing a clause's literal
+    // block distance. We can't re-use lstamp for this since LBDs get
+    // recomputed in the middle of resolution, when lstamp still carries state
+    // needed for redundant literal detection.
+    std::vector<unsigned long> lbd_stamp;
+    unsigned long lbd_epoch;
+
+    // Scratch storage for the vars unwound by backjump, reinserted into the
+    // heap in bulk.
+    std::vector<lit_t> rewound;
+
     // Current number of lemmas: the number of clauses we've learned through
     // resolution and are keeping in the clause database.
     size_t nlemmas;
@@ -298,19 +740,58 @@ struct Cnf {
     // Have we seen a conflict in the current search path? Useful in full runs.
     bool seen_conflict;
 
+    // Assumption literals for the current solve() call, acting as forced
+    // decisions at the lowest decision levels. Empty outside of the
+    // incremental interface (incremental.h).
+    std::vector<lit_t> assumptions;
+
+    // Set once a conflict is found at level 0: the clause database itself,
+    // not just the current assumptions, is unsatisfiable.
+    bool unsat;
+
     // A black box that tells us when to restart. Every time a literal is
     // assigned a value, we tell this oracle about it. Every time we learn
     // a new lemma, we ask it if we should restart.
     restart_oracle agility;
 
+    // The alternative LBD-based restart oracle, used when restart_policy=1.
+    // Fed in learn_clause; agility above is still bumped on every assignment
+    // either way so the phase_changes counter stays meaningful.
+    ema_restart_oracle ema;
+
     // The number of database purges/reductions we've performed.
     size_t npurges;
 
-    FILE* prooflog;
+    // Number of database reductions at the time of the last vivification
+    // pass: vivify() is only worth re-running once reduce_db has filtered a
+    // fresh batch of lemmas down to the keepers.
+    size_t vivify_purges;
+
+    // Telemetry state: total conflicts seen, plus the conflict count and
+    // wall clock at the last status line so we can report conflicts/sec.
+    // Only maintained when telemetry_interval is non-zero.
+    uint64_t nconflicts;
+    uint64_t telemetry_conflicts;
+    struct timespec telemetry_time;
 
-    Cnf(Processor* p) :
+    // Lemma exchange for multi-worker mode, or nullptr when single-threaded.
+    // import_cursor is this worker's read position in the exchange buffer.
+    ClauseExchange* exchange;
+    uint64_t import_cursor;
+    uint32_t worker_id;
+
+    ProofWriter* prooflog;
+
+    Cnf(Processor* p) : Cnf(p, p->nvars()) {}
+
+    // Constructs a solver over nv variables with no backing Processor. Used
+    // by the incremental interface (incremental.h), which supplies clauses
+    // through add_clause instead of parse().
+    explicit Cnf(size_t nv) : Cnf(nullptr, nv) {}
+
+    Cnf(Processor* p, size_t nv) :
         p(p),
-        nvars(p->nvars()),
+        nvars(nv),
         val(nvars + 1, UNSET),
         lev(nvars + 1, -1),
         oval(nvars + 1, FALSE),
@@ -322,25 +803,40 @@ struct Cnf {
         next_trail_index(0),
         di(nvars + 1, 0),
         reason(nvars + 1, clause_nil),
-        watch_storage(2 * nvars + 1, clause_nil),
+        watch_storage(2 * nvars + 1),
         watch(&watch_storage[nvars]),
+        bimp_storage(2 * nvars + 1),
+        bimp(&bimp_storage[nvars]),
         b(nvars, -1),
         trail_lits(nvars),
         epoch(0),
+        lbd_stamp(nvars + 1, 0),
+        lbd_epoch(0),
         nlemmas(0),
+        lemma_start(kHeaderSize),
         d(0),
         full_runs(PARAM_warm_up_runs),
         confp(0),
         seen_conflict(false),
+        unsat(false),
         agility(PARAM_restart_sensitivity),
         npurges(0),
+        vivify_purges(0),
+        nconflicts(0),
+        telemetry_conflicts(0),
+        exchange(nullptr),
+        import_cursor(0),
+        worker_id(0),
         prooflog(0) {
         trail.reserve(nvars + 1);
+        clock_gettime(CLOCK_MONOTONIC_RAW, &telemetry_time);
         heap.shuffle_init();
-        if (FLAGS_dratfile != "") prooflog = fopen(FLAGS_dratfile.c_str(), "w");
+        if (FLAGS_dratfile != "") {
+            prooflog = new ProofWriter(FLAGS_dratfile.c_str());
+        }
     }
 
-    ~Cnf() { if (prooflog != 0) fclose(prooflog); }
+    ~Cnf() { if (prooflog != 0) delete prooflog; }
 
     // Is the literal x false under the current assignment?
     inline bool is_false(lit_t x) const {
@@ -354,6 +850,41 @@ struct Cnf {
         return (x > 0 && s == TRUE) || (x < 0 && s == FALSE);
     }
 
+    // Index of the first literal at or after position `from` in the clause
+    // at cindex that isn't false under the current assignment, or
+    // SIZE(cindex) if every remaining literal is false. This is the scan at
+    // the heart of step C4 -- long learned clauses make it hot in every
+    // profile, so it gets a SIMD fast path when one is available.
+    size_t find_non_false(clause_t cindex, size_t from) const {
+        size_t cs = SIZE(cindex);
+        size_t i = from;
+#if defined(__AVX2__) && defined(LIT_32) && defined(CLAUSE_32)
+        // Eight literals at a time: gather their variables' states, then
+        // compare the whole batch against FALSE/TRUE at once. A literal l is
+        // false exactly when val[var(l)] == (l > 0 ? FALSE : TRUE), so we
+        // compute both compares and select per lane by the literal's sign.
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i fv = _mm256_set1_epi32(FALSE);
+        const __m256i tv = _mm256_set1_epi32(TRUE);
+        const int* vals = reinterpret_cast<const int*>(val.data());
+        for (; i + 8 <= cs; i += 8) {
+            __m256i lits = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(&clauses[cindex + i]));
+            __m256i vars = _mm256_abs_epi32(lits);
+            __m256i v = _mm256_i32gather_epi32(vals, vars, 4);
+            __m256i lit_false = _mm256_blendv_epi8(
+                _mm256_cmpeq_epi32(v, tv), _mm256_cmpeq_epi32(v, fv),
+                _mm256_cmpgt_epi32(lits, zero));
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(lit_false));
+            if (mask != 0xff) return i + __builtin_ctz(~mask);
+        }
+#endif
+        for (; i < cs; ++i) {
+            if (!is_false(clauses[cindex + i].lit)) return i;
+        }
+        return cs;
+    }
+
     // Have we assigned values to all variables?
     inline bool trail_complete() const {
         return trail.size() == nvars;
@@ -367,6 +898,14 @@ struct Cnf {
         clause_t os = 0;
         for(clause_t i = start_index - 1; i < clauses.size();
             i += os + ts + kHeaderSize) {
+            // Arena padding can push the first clause past start_index. When
+            // that happens i lands on a tombstone run instead of a size
+            // element; skip the run and the two scratch elements behind it.
+            if (clauses[i].lit == lit_nil) {
+                while (i < clauses.size() && clauses[i].lit == lit_nil) ++i;
+                i += 2;
+                if (i >= clauses.size()) break;
+            }
             os = clauses[i].size;
             clause_t ii = i + clauses[i].size + 1;
             ts = 0;
@@ -406,19 +945,18 @@ struct Cnf {
 
     std::string watchlist_debug_string(lit_t l) {
         std::ostringstream oss;
-        for (clause_t c = watch[l]; c != clause_nil;
-             clauses[c].lit == l ? (c = WATCH0(c)) : (c = WATCH1(c))) {
-            oss << "[" << c << "] " << clause_debug_string(c) << " ";
+        for (const Watcher& w : watch[l]) {
+            oss << "[" << w.c << "] " << clause_debug_string(w.c) << " ";
         }
         return oss.str();
     }
 
-    // Assuming l is either LIT0 or LIT1 in clause c, swap lits and watchlist
-    // pointers so that l is LIT0.
+    // Assuming l is either LIT0 or LIT1 in clause c, swap lits so that l is
+    // LIT0. Watcher entries don't record which of the two slots their literal
+    // occupies, so no watchlist surgery is needed.
     void force_lit0(lit_t l, clause_t c) {
         if (LIT0(c) != l) {
             std::swap(LIT0(c), LIT1(c));
-            std::swap(WATCH0(c), WATCH1(c));
         }
         CHECK(LIT0(c) == l) << "Expected " << l << " to be LIT0 or LIT1 in "
                             << clause_debug_string(c);
@@ -456,22 +994,11 @@ struct Cnf {
         return true;
     }
 
-    // Adds clause at cindex to lit's watchlist.
+    // Adds clause at cindex to lit's watchlist, caching the other watched
+    // literal as the blocking literal.
     void add_to_watchlist(clause_t cindex, lit_t lit) {
-        if (PARAM_sorted_watchlists != 1) {
-            (LIT0(cindex) == lit ? WATCH0(cindex) : WATCH1(cindex)) =
-                watch[lit];
-            watch[lit] = cindex;
-        } else {
-            size_t cs = SIZE(cindex);
-            clause_t* x = &watch[lit];
-            // TODO: try sorting by LBD
-            while (*x != clause_nil && SIZE(*x) < cs) {
-                x = &(LIT0(*x) == lit ? WATCH0(*x) : WATCH1(*x));
-            }
-            (LIT0(cindex) == lit ? WATCH0(cindex) : WATCH1(cindex)) = *x;
-            *x = cindex;
-        }
+        watch[lit].push_back(
+            {cindex, LIT0(cindex) == lit ? LIT1(cindex) : LIT0(cindex)});
     }
 
     // For a clause c = l_0 l_1 ... l_k at index cindex in the clauses array,
@@ -479,16 +1006,41 @@ struct Cnf {
     // watchlist. No-op if k == 0.
     void remove_from_watchlist(clause_t cindex, lit_t offset) {
         if (offset == 1 && SIZE(cindex) == 1) return;
-        clause_t l = cindex + offset;
-        clause_t* x = &watch[clauses[l].lit];
-        while (*x != cindex) {
-            if (LIT0(*x) == clauses[l].lit) {
-                x = (clause_t*)(&WATCH0(*x));
-            } else /* LIT1(*x) == clauses[l].lit */ {
-                x = (clause_t*)(&WATCH1(*x));
+        std::vector<Watcher>& wl = watch[clauses[cindex + offset].lit];
+        for (size_t i = 0; i < wl.size(); ++i) {
+            if (wl[i].c == cindex) {
+                wl[i] = wl.back();
+                wl.pop_back();
+                return;
             }
         }
-        *x = LIT0(*x) == clauses[l].lit ? WATCH0(*x) : WATCH1(*x);
+        CHECK(false) << "Didn't find " << cindex << " in watchlist of "
+                     << clauses[cindex + offset].lit;
+    }
+
+    // Registers the binary clause at cindex in both of its literals'
+    // implication lists.
+    void add_bimps(clause_t cindex) {
+        bimp[-LIT0(cindex)].push_back({LIT1(cindex), cindex});
+        bimp[-LIT1(cindex)].push_back({LIT0(cindex), cindex});
+    }
+
+    // Removes the binary clause at cindex from both implication lists.
+    void remove_bimps(clause_t cindex) {
+        remove_bimp(-LIT0(cindex), cindex);
+        remove_bimp(-LIT1(cindex), cindex);
+    }
+
+    void remove_bimp(lit_t l, clause_t cindex) {
+        std::vector<Bimp>& bl = bimp[l];
+        for (size_t i = 0; i < bl.size(); ++i) {
+            if (bl[i].c == cindex) {
+                bl[i] = bl.back();
+                bl.pop_back();
+                return;
+            }
+        }
+        CHECK(false) << "Didn't find " << cindex << " in bimp list of " << l;
     }
 
     // Knuth's blit subroutine described in the answer to Exercise 263.
@@ -531,6 +1083,7 @@ struct Cnf {
 
     // Rewinds the search to the given level.
     void backjump(lit_t level) {
+        rewound.clear();
         while (trail.size() > di[level+1]) {
             lit_t k = var(trail.back());
             trail.pop_back();
@@ -538,43 +1091,73 @@ struct Cnf {
             val[k] = UNSET;
             reason[k] = clause_nil;
             conflict[lev[k]] = clause_nil;
-            heap.insert(k);
+            rewound.push_back(k);
         }
+        heap.bulk_insert(rewound);
         next_trail_index = trail.size();
         d = level;
     }
 
+    // Computes the literal block distance of the clause at cindex: the number
+    // of distinct levels among its literals. Every literal in the clause must
+    // currently be assigned.
+    lit_t compute_lbd(clause_t cindex) {
+        ++lbd_epoch;
+        lit_t lbd = 0;
+        for (size_t j = 0; j < SIZE(cindex); ++j) {
+            lit_t p = lev[var(clauses[cindex + j].lit)];
+            if (lbd_stamp[p] != lbd_epoch) {
+                lbd_stamp[p] = lbd_epoch;
+                ++lbd;
+            }
+        }
+        return lbd;
+    }
+
     // Install the new clause of length r, currently in temp storage at b,
     // as the reason for literal lp at level dp. Returns the new clause index.
     clause_t learn_clause(lit_t lp, clause_t r, lit_t dp) {
         // Initialize the new clause. All of the nils we set here will be set
         // to real values below.
-        clauses.push_back({.ptr = clause_nil});  // WATCH1
-        clauses.push_back({.ptr = clause_nil});  // WATCH0
-        clauses.push_back({.size = r+1});  // SIZE
-        clause_t lc = clauses.size();
-        clauses.push_back({.lit = -lp});  // LIT0
-        add_to_watchlist(lc, -lp);
+        clause_t lc = clauses.start_clause(r+1);
+        clauses.push_back({.lit = lit_t(-lp)});  // LIT0
         clauses.push_back({.lit = lit_nil});  // LIT1, set below.
         // Need to watch a literal at level dp.
         bool found_watch = false;
         for (size_t j = 0; j < r; ++j) {
             if (found_watch || lev[var(b[j])] < dp) {
-                clauses.push_back({-b[j]});
+                clauses.push_back({lit_t(-b[j])});
             } else {
                 LIT1(lc) = -b[j];
-                add_to_watchlist(lc, -b[j]);
                 found_watch = true;
             }
         }
         CHECK(r == 0 || found_watch) << "Didn't find watched lit in new clause";
+        // All literals in a learned clause are assigned at conflict time, so
+        // we can record the clause's LBD in its header right away.
+        LBD(lc) = compute_lbd(lc);
+        if (PARAM_restart_policy == 1) ema.learned(LBD(lc), trail.size());
+        if (r + 1 == 2) {
+            add_bimps(lc);
+        } else {
+            add_to_watchlist(lc, -lp);
+            if (found_watch) add_to_watchlist(lc, LIT1(lc));
+        }
         CHECK_NO_OVERFLOW(clause_t, clauses.size());
 
         if (prooflog) {
+            prooflog->start(false);
             for(size_t j = 0; j < r+1; ++j) {
-                fprintf(prooflog, "%d ", clauses[lc+j].lit);
+                prooflog->lit(clauses[lc+j].lit);
             }
-            fprintf(prooflog, "0\n");
+            prooflog->end();
+        }
+
+        if (exchange != nullptr && r + 1 <= PARAM_share_size_limit) {
+            lit_t sbuf[ClauseExchange::kMaxLits];
+            for (size_t j = 0; j < r + 1; ++j) { sbuf[j] = clauses[lc+j].lit; }
+            exchange->publish(worker_id, sbuf, r+1);
+            INC(published_clauses);
         }
 
         ++nlemmas;
@@ -584,25 +1167,125 @@ struct Cnf {
         return lc;
     }
 
+    // Installs one clause imported from another worker. Must be called at
+    // level 0. Literals false at level 0 are dropped and clauses with a
+    // literal true at level 0 are skipped entirely; whatever survives is
+    // added as a lemma (or forced onto the trail, if only one literal
+    // remains).
+    void install_shared(lit_t* lits, uint32_t size) {
+        uint32_t n = 0;
+        for (uint32_t i = 0; i < size; ++i) {
+            if (is_true(lits[i])) return;
+            if (is_false(lits[i])) continue;
+            lits[n++] = lits[i];
+        }
+        if (n == 0) UNSAT_EXIT;
+        if (n == 1) {
+            LOG(2) << "Imported unit clause " << lits[0];
+            add_to_trail(lits[0], clause_nil);
+            INC(imported_units);
+            return;
+        }
+        clause_t lc = clauses.start_clause(n);
+        for (uint32_t i = 0; i < n; ++i) { clauses.push_back({lits[i]}); }
+        CHECK_NO_OVERFLOW(clause_t, clauses.size());
+        // Imported literals are all unassigned here, so we can't compute a
+        // real LBD. Use the clause size as a pessimistic stand-in; it'll be
+        // refreshed if the clause ever becomes a reason.
+        LBD(lc) = n;
+        if (n == 2) {
+            add_bimps(lc);
+        } else {
+            add_to_watchlist(lc, LIT0(lc));
+            add_to_watchlist(lc, LIT1(lc));
+        }
+        ++nlemmas;
+        LOG(2) << "Imported clause: " << clause_debug_string(lc);
+        INC(imported_clauses);
+    }
+
+    // Installs a clause supplied through the incremental interface. Must be
+    // called at level 0. As in install_shared, literals false at the root
+    // are dropped and clauses with a literal true at the root are skipped.
+    // A clause added after search has begun lands above lemma_start, so it's
+    // marked with a negative LBD, which reduce_db treats as "never evict".
+    // Returns false iff the clause makes the formula unsatisfiable at the
+    // root.
+    bool add_clause(std::vector<lit_t> lits) {
+        CHECK(d == 0) << "add_clause called above level 0";
+        std::sort(lits.begin(), lits.end(), [](lit_t x, lit_t y) {
+            return var(x) < var(y) || (var(x) == var(y) && x < y);
+        });
+        lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+        for (size_t i = 0; i + 1 < lits.size(); ++i) {
+            if (lits[i] == -lits[i+1]) return true;  // Tautology.
+        }
+        uint32_t n = 0;
+        for (size_t i = 0; i < lits.size(); ++i) {
+            if (is_true(lits[i])) return true;
+            if (is_false(lits[i])) continue;
+            lits[n++] = lits[i];
+        }
+        if (n == 0) {
+            LOG(2) << "Added clause is false at level 0.";
+            unsat = true;
+            return false;
+        }
+        if (n == 1) {
+            LOG(2) << "Added unit clause " << lits[0];
+            add_to_trail(lits[0], clause_nil);
+            return true;
+        }
+        clause_t lc = clauses.start_clause(n);
+        for (uint32_t i = 0; i < n; ++i) { clauses.push_back({lits[i]}); }
+        CHECK_NO_OVERFLOW(clause_t, clauses.size());
+        LBD(lc) = -1;  // Original clause, not a lemma: never evict.
+        if (n == 2) {
+            add_bimps(lc);
+        } else {
+            add_to_watchlist(lc, LIT0(lc));
+            add_to_watchlist(lc, LIT1(lc));
+        }
+        LOG(2) << "Added clause: " << clause_debug_string(lc);
+        INC(added_clauses);
+        return true;
+    }
+
+    // Drains the exchange buffer, installing everything other workers have
+    // published since the last import. Called at restart boundaries.
+    void import_shared() {
+        lit_t buf[ClauseExchange::kMaxLits];
+        uint32_t size = 0;
+        while (exchange->consume(worker_id, &import_cursor, buf, &size)) {
+            install_shared(buf, size);
+        }
+    }
+
     // Removes a large fraction of the lemmas in the clause database that we
     // don't think will be useful in the future. Returns the final clause in the
-    // reduced clause database. Literal block distance (LBD) and clause length
-    // are used as indicators of future clause usefulness. This function must
-    // only be called after a full run so that LBD can be calculated on each
-    // clause (each variable needs a level assigned for LBD). We pin all clauses
-    // that are active reasons for literals on the trail so restarting is not
-    // necessary after running this function. The target fraction of lemmas to
-    // keep is controlled by PARAMS_reduce_db_fraction.
+    // reduced clause database (or clause_nil if no lemmas survive). Literal
+    // block distance (LBD) and clause length
+    // are used as indicators of future clause usefulness; each lemma's LBD is
+    // stored in its header at learn time, so this function can be called at
+    // any point in the search. We pin all clauses that are active reasons for
+    // literals on the trail so restarting is not necessary after running this
+    // function. The target fraction of lemmas to keep is controlled by
+    // PARAMS_reduce_db_fraction.
     clause_t reduce_db() {
         Timer t("clause database purges");
+        Phase phase(PHASE_reduce_db);
         size_t target_lemmas = nlemmas * PARAM_reduce_db_fraction;
 
         // We make a few passes over the clauses and keep track of anything we
         // want to keep with PIN(c). If PIN(c) > 0, we don't care to keep the
         // clause. If PIN(c) == 0, we want to keep the clause because of its
         // size or LBD. If PIN(c) < 0, we want to keep the clause because it's
-        // the current reason for variable -PIN(c).
-        for_each_lemma([&](clause_t c, clause_t cs) { PIN(c) = 1; });
+        // the current reason for variable -PIN(c). Clauses with a negative
+        // LBD are original clauses installed through add_clause after search
+        // began; they're kept unconditionally.
+        for_each_lemma([&](clause_t c, clause_t cs) {
+            PIN(c) = LBD(c) < 0 ? 0 : 1;
+        });
 
         // Pin lemmas that are reasons.
         for (lit_t l : trail) {
@@ -613,11 +1296,12 @@ struct Cnf {
             if (target_lemmas > 0) --target_lemmas;
         }
 
-        // Pin any small clauses. For anything else, compute LBD. Store lemma
-        // indexes of LBD candidates so we can iterate in reverse over clauses.
-        std::vector<clause_t> lbds(d+2, 0);
-        std::vector<clause_t> hist(d+2, 0);  // lbd histogram.
-        std::vector<lit_t> lemma_indexes;
+        // Pin any small clauses. For anything else, histogram the LBD stored
+        // in the clause header. Store lemma indexes of LBD candidates so we
+        // can iterate in reverse over clauses.
+        std::vector<clause_t> hist(nvars+2, 0);  // lbd histogram.
+        std::vector<clause_t> lemma_indexes;
+        lit_t lbd_seen = 0;
         for_each_lemma([&](clause_t c, clause_t cs) {
             if (target_lemmas == 0) return;  // continue
             if (PIN(c) < 1) return;  // continue, already pinned
@@ -627,24 +1311,19 @@ struct Cnf {
                 return; // continue
             }
             lemma_indexes.push_back(c);
-            int lbd = 0;
-            for(size_t j = 0; j < cs; ++j) {
-                lit_t v = var(clauses[c+j].lit);
-                CHECK(val[v] != UNSET) << "reduce_db called without full run.";
-                lbds[lev[v]] = c;
-            }
-            for(lit_t j = 0; j <= d; ++j) { if (lbds[j] == c) ++lbd; }
-            LBD(c) = lbd;
-            CHECK(lbd > 0 && lbd <= d+1)
-                << "Computed impossible LBD: " << lbd << " (d = " << d << ")";
+            lit_t lbd = LBD(c);
+            CHECK(lbd > 0 && size_t(lbd) <= nvars+1)
+                << "Stored impossible LBD: " << lbd;
+            lbd_seen = std::max(lbd_seen, lbd);
             hist[lbd]++;
         });
 
         // Figure out the max LBD we can afford to keep while staying within our
         // target eviction budget.
-        int max_lbd = 1;
+        lit_t max_lbd = 1;
         size_t lbd_evictions = 0;
-        while (max_lbd <= d && lbd_evictions + hist[max_lbd] <= target_lemmas) {
+        while (max_lbd <= lbd_seen &&
+               lbd_evictions + hist[max_lbd] <= target_lemmas) {
             lbd_evictions += hist[max_lbd];
             ++max_lbd;
         }
@@ -656,7 +1335,7 @@ struct Cnf {
 
         // Mark clauses we want to keep because of LBD.
         for(size_t i = 0; i < lemma_indexes.size(); ++i) {
-            lit_t lc = lemma_indexes[lemma_indexes.size() - i - 1];
+            clause_t lc = lemma_indexes[lemma_indexes.size() - i - 1];
             if (PIN(lc) < 1) continue;  // already pinned
             if (LBD(lc) == max_lbd && max_lbd_budget > 0) {
                 PIN(lc) = 0;
@@ -666,45 +1345,294 @@ struct Cnf {
             }
         }
 
-        // Clear top-level watch pointers.
-        for(size_t i = 0; i < watch_storage.size(); ++i) {
-            watch_storage[i] = clause_nil;
-        }
-
-        // Compact clauses.
-        lit_t tail = lemma_start;
+        // Compact clauses, recording the new index of each surviving lemma.
+        // Both columns of the relocation map are increasing, so we can look
+        // up old indexes with a binary search below.
+        std::vector<std::pair<clause_t, clause_t>> reloc;
+        reloc.reserve(nlemmas);
+        clause_t last_clause = clause_nil;
+        clause_t tail = lemma_start;
         nlemmas = 0;
         for_each_lemma([&](clause_t c, clause_t cs) {
-            if (PIN(c) > 0) return;  // continue
+            if (PIN(c) > 0) {
+                // Tell the proof checker the lemma is dead so it doesn't keep
+                // verifying against it.
+                if (prooflog) {
+                    prooflog->start(true);
+                    for(size_t j = 0; j < cs; ++j) {
+                        prooflog->lit(clauses[c+j].lit);
+                    }
+                    prooflog->end();
+                }
+                return;  // continue
+            }
+            // Re-pad for alignment at the destination; the surviving clause
+            // never moves up since its old position was padded identically.
+            tail = clauses.place(tail, cs);
             if (PIN(c) < 0) {
                 reason[var(PIN(c))] = tail;
             }
-            // If WATCH1 isn't set to something, it might be lit_nil. If it's
-            // lit_nil, it could look like a tombstoned literal instead of a
-            // watch pointer. So we set it explictly here, even though we'll
-            // overwrite it when we recompute watchlists in the next for loop.
-            WATCH1(tail) = clause_nil;
+            reloc.push_back({c, tail});
+            last_clause = tail;
+            // Carry the stored LBD along with the clause. LBD is always
+            // nonzero, so this also keeps the scratch element from looking
+            // like a tombstoned literal when iterating over clauses. (Read
+            // it before writing since source and destination can overlap.)
+            lit_t lbd = LBD(c);
+            LBD(tail) = lbd;
             SIZE(tail) = cs;
             for(size_t j = 0; j < cs; ++j) {
                 clauses[tail+j].lit = clauses[c+j].lit;
             }
             tail += cs + kHeaderSize;
-            ++nlemmas;
+            // Permanent clauses don't count against the lemma budget.
+            if (lbd > 0) ++nlemmas;
         });
         clauses.resize(tail - kHeaderSize);
 
-        // Recompute all watch lists
-        clause_t last_clause = clause_nil;
-        for_each_clause([&](clause_t c, clause_t cs) {
-            if (cs > 1) {
-                add_to_watchlist(c, LIT0(c));
-                add_to_watchlist(c, LIT1(c));
+        // Patch watcher and binary implication entries that refer to lemmas:
+        // surviving lemmas get their relocated index, evicted lemmas are
+        // dropped. Entries for original clauses pass through untouched, so
+        // this sweep is linear in the number of watchers and never loads
+        // clause memory.
+        for(size_t i = 0; i < watch_storage.size(); ++i) {
+            std::vector<Watcher>& wl = watch_storage[i];
+            size_t wi = 0;
+            for(size_t ri = 0; ri < wl.size(); ++ri) {
+                if (wl[ri].c >= lemma_start) {
+                    clause_t nc = relocate(reloc, wl[ri].c);
+                    if (nc == clause_nil) continue;  // evicted
+                    wl[ri].c = nc;
+                }
+                wl[wi++] = wl[ri];
             }
-            last_clause = c;
-        });
+            wl.resize(wi);
+
+            std::vector<Bimp>& bl = bimp_storage[i];
+            size_t bi = 0;
+            for(size_t ri = 0; ri < bl.size(); ++ri) {
+                if (bl[ri].c >= lemma_start) {
+                    clause_t nc = relocate(reloc, bl[ri].c);
+                    if (nc == clause_nil) continue;  // evicted
+                    bl[ri].c = nc;
+                }
+                bl[bi++] = bl[ri];
+            }
+            bl.resize(bi);
+        }
         return last_clause;
     }
 
+    // Looks up a lemma's post-compaction index in the relocation map built by
+    // reduce_db, or clause_nil if the lemma was evicted.
+    static clause_t relocate(
+        const std::vector<std::pair<clause_t, clause_t>>& reloc, clause_t c) {
+        auto it = std::lower_bound(
+            reloc.begin(), reloc.end(), c,
+            [](const std::pair<clause_t, clause_t>& e, clause_t v) {
+                return e.first < v;
+            });
+        if (it == reloc.end() || it->first != c) return clause_nil;
+        return it->second;
+    }
+
+    // Propagates all literals on the trail past next_trail_index, returning
+    // the index of a conflicting clause, or clause_nil if propagation reached
+    // a fixed point. This is a stripped-down copy of steps C3/C4 in solve()
+    // for use by vivify() below: no conflict bookkeeping and no level-zero
+    // tombstoning, since anything learned here is undone immediately.
+    clause_t probe_propagate() {
+        while (next_trail_index < trail.size()) {
+            lit_t l = trail[next_trail_index++];
+            for (const Bimp& b : bimp[l]) {
+                if (is_true(b.l)) continue;
+                if (is_false(b.l)) return b.c;
+                add_to_trail(b.l, b.c);
+            }
+            std::vector<Watcher>& wl = watch[-l];
+            size_t ri = 0, wi = 0;
+            clause_t w = clause_nil;
+            for (; w == clause_nil && ri < wl.size(); ++ri) {
+                if (is_true(wl[ri].blit)) {
+                    wl[wi++] = wl[ri];
+                    continue;
+                }
+                clause_t cw = wl[ri].c;
+                force_lit0(-l, cw);
+                if (is_true(LIT1(cw))) {
+                    wl[wi++] = {cw, LIT1(cw)};
+                    continue;
+                }
+                size_t nf = find_non_false(cw, 2);
+                if (nf < SIZE(cw)) {
+                    lit_t ln = clauses[cw + nf].lit;
+                    std::swap(LIT0(cw), clauses[cw + nf].lit);
+                    add_to_watchlist(cw, ln);
+                    continue;
+                }
+                wl[wi++] = {cw, LIT1(cw)};
+                if (is_false(LIT1(cw))) {
+                    w = cw;
+                    ++ri;
+                    break;
+                }
+                add_to_trail(LIT1(cw), cw);
+            }
+            for (; ri < wl.size(); ++ri) { wl[wi++] = wl[ri]; }
+            wl.resize(wi);
+            if (w != clause_nil) return w;
+        }
+        return clause_nil;
+    }
+
+    // Tries to shorten the lemma at cindex by vivification (Piette, Hamadi,
+    // and Saïs): assume the negation of each of its literals in turn,
+    // propagating after each one. A literal falsified by the assumed prefix
+    // alone can be dropped from the clause, and if propagation derives a
+    // conflict or one of the remaining literals, the clause can be replaced
+    // by the prefix examined so far. Must be called at level 0 with a fully
+    // propagated trail. Decrements *budget by the number of literals probing
+    // pushed onto the trail. Returns false iff the clause shrank to nothing,
+    // which means the formula is unsatisfiable.
+    bool vivify_clause(clause_t cindex, size_t* budget) {
+        clause_t cs = SIZE(cindex);
+        // A clause that's satisfied at level 0 is dead weight for reduce_db
+        // to collect eventually; don't spend any probes on it.
+        for (size_t i = 0; i < cs; ++i) {
+            lit_t ln = clauses[cindex + i].lit;
+            if (is_true(ln) && lev[var(ln)] == 0) return true;
+        }
+        remove_from_watchlist(cindex, 0);
+        remove_from_watchlist(cindex, 1);
+        ++d;
+        di[d] = trail.size();
+        size_t keep = 0;
+        bool shortened = false;
+        for (size_t i = 0; i < cs; ++i) {
+            lit_t ln = clauses[cindex + i].lit;
+            if (is_false(ln)) {
+                // The assumed prefix already implies ~ln, so ln contributes
+                // nothing to the clause.
+                shortened = true;
+                continue;
+            }
+            if (is_true(ln)) {
+                // The assumed prefix implies ln: the prefix plus ln is a
+                // clause that subsumes this one.
+                b[keep++] = ln;
+                shortened = shortened || i + 1 < cs;
+                break;
+            }
+            b[keep++] = ln;
+            add_to_trail(-ln, clause_nil);
+            if (probe_propagate() != clause_nil) {
+                // The assumed prefix is contradictory, so its negation -- the
+                // prefix of the clause we've examined so far -- is implied.
+                shortened = shortened || i + 1 < cs;
+                break;
+            }
+        }
+        size_t probed = trail.size() - di[d];
+        *budget -= std::min(*budget, probed);
+        backjump(d - 1);
+
+        if (!shortened) {
+            add_to_watchlist(cindex, LIT0(cindex));
+            add_to_watchlist(cindex, LIT1(cindex));
+            return true;
+        }
+
+        // Tell the proof checker about the shortened clause before retiring
+        // the original, so the addition has the original to resolve against.
+        if (prooflog) {
+            prooflog->start(false);
+            for (size_t i = 0; i < keep; ++i) { prooflog->lit(b[i]); }
+            prooflog->end();
+            prooflog->start(true);
+            for (size_t i = 0; i < cs; ++i) {
+                prooflog->lit(clauses[cindex + i].lit);
+            }
+            prooflog->end();
+        }
+
+        if (keep == 0) return false;
+
+        // Shrink the clause in place. Tombstones after the final literal are
+        // skipped by for_each_clause when it walks to the next header.
+        for (size_t i = 0; i < keep; ++i) { clauses[cindex + i].lit = b[i]; }
+        for (size_t i = keep; i < cs; ++i) { clauses[cindex + i].lit = lit_nil; }
+        SIZE(cindex) = keep;
+        if (LBD(cindex) > static_cast<lit_t>(keep)) {
+            LBD(cindex) = static_cast<lit_t>(keep);
+        }
+        INC(vivified_clauses);
+        INC(vivified_literals, cs - keep);
+        if (keep == 1) {
+            // A new unit: watch it like learn_clause does and force it at
+            // level 0. The caller propagates it before the next probe.
+            add_to_watchlist(cindex, LIT0(cindex));
+            add_to_trail(LIT0(cindex), cindex);
+            INC(vivified_units);
+        } else if (keep == 2) {
+            add_bimps(cindex);
+        } else {
+            add_to_watchlist(cindex, LIT0(cindex));
+            add_to_watchlist(cindex, LIT1(cindex));
+        }
+        return true;
+    }
+
+    // Vivifies every low-LBD lemma, stopping early if the probing budget
+    // runs out. Must be called at level 0 with a fully propagated trail,
+    // right after a restart. Returns false iff vivification proved the
+    // formula unsatisfiable.
+    bool vivify() {
+        Timer t("vivification");
+        Phase phase(PHASE_vivification);
+        size_t budget = PARAM_vivify_budget;
+        std::vector<clause_t> candidates;
+        for_each_lemma([&](clause_t c, clause_t cs) {
+            if (cs < 3) return;  // continue
+            lit_t lbd = LBD(c);
+            if (lbd <= 0 || lbd > PARAM_vivify_max_lbd) return;  // continue
+            candidates.push_back(c);
+        });
+        // Vivification only shrinks clauses in place, so the candidate
+        // indexes stay valid throughout the pass.
+        for (clause_t cc : candidates) {
+            if (budget == 0) break;
+            if (!vivify_clause(cc, &budget)) return false;
+            // Propagate any fresh unit at level 0 so its consequences stick
+            // instead of being assigned at probe level and rolled back.
+            if (probe_propagate() != clause_nil) return false;
+        }
+        return true;
+    }
+
+    // Prints one compact status line: conflict throughput since the last
+    // line plus a snapshot of where the search is. Level, trail fill, and
+    // agility distinguish a stuck solver from one making progress; clause
+    // memory catches runaway lemma growth.
+    void print_telemetry() {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+        double secs = (now.tv_sec - telemetry_time.tv_sec) +
+            (now.tv_nsec - telemetry_time.tv_nsec) / 1e9;
+        uint64_t rate = secs > 0 ?
+            (nconflicts - telemetry_conflicts) / secs : 0;
+        PRINT << "c status: conflicts=" << nconflicts
+              << " conflicts/sec=" << rate
+              << " level=" << d
+              << " trail=" << trail.size() / static_cast<double>(nvars)
+              << " lemmas=" << nlemmas
+              << " agility=" << agility.agility / 4294967296.0
+              << " clause_mb="
+              << clauses.size() * sizeof(clause_elem_t) / 1048576.0
+              << std::endl;
+        telemetry_conflicts = nconflicts;
+        telemetry_time = now;
+    }
+
     void print_assignment() {
         p->val.resize(nvars + 1, false);  // In case preprocessing is disabled.
         for (size_t i = 1; i <= nvars; ++i) {
@@ -716,54 +1644,61 @@ struct Cnf {
     }
 };
 
-Cnf parse(Processor* p) {
+Cnf* parse(Processor* p) {
     Timer t("parse");
     p->reset();
-    Cnf c(p);
+    // Workers in multi-worker mode each need their own Cnf, so parse
+    // allocates: Cnf owns a raw pointer into watch_storage and can't be
+    // safely copied or moved.
+    Cnf* c = new Cnf(p);
+    // Literals are buffered per clause so the arena can be told the clause
+    // size up front, which it needs to pad for alignment.
+    std::vector<lit_t> lits;
     while (!p->eof()) {
-        c.clauses.push_back({.ptr = clause_nil});  // watch ptr for second lit.
-        c.clauses.push_back({.ptr = clause_nil});  // watch ptr for first lit.
-        c.clauses.push_back({.size = 0});          // size of clause. set below.
-        std::size_t start = c.clauses.size();
+        lits.clear();
         for (p->advance(); !p->eoc(); p->advance()) {
-            c.clauses.push_back({p->curr()});
+            lits.push_back(p->curr());
         }
-        int cs = c.clauses.size() - start;
+        int cs = lits.size();
         if (!p->eof() && cs == 0) {
             LOG(2) << "Empty clause in input file, unsatisfiable formula.";
             UNSAT_EXIT;
         } else if (p->eof() && cs == 0) {
-            // Clean up from (now unnecessary) c.clauses.push_backs above.
-            for(clause_t i = 0; i < kHeaderSize; ++i) { c.clauses.pop_back(); }
             break;
         } else if (cs == 1) {
-            lit_t x = c.clauses[c.clauses.size() - 1].lit;
+            lit_t x = lits[0];
             LOG(3) << "Found unit clause " << x;
             State s = x < 0 ? FALSE : TRUE;
             lit_t v = var(x);
-            if (c.val[v] != UNSET && c.val[v] != s) {
+            if (c->val[v] != UNSET && c->val[v] != s) {
                 LOG(2) << "Contradictory unit clauses, unsatisfiable formula.";
                 UNSAT_EXIT;
-            } else if (c.val[v] == UNSET) {
-                c.val[v] = s;
-                c.tloc[v] = c.trail.size();
-                c.trail.push_back(x);
-                c.lev[v] = 0;
+            } else if (c->val[v] == UNSET) {
+                c->val[v] = s;
+                c->tloc[v] = c->trail.size();
+                c->trail.push_back(x);
+                c->lev[v] = 0;
             } else {
                 LOG(1) << "Duplicate unit (" << x << "). Skipping from now on.";
             }
         }
         CHECK(cs > 0);
-        // Record the size of the clause in offset -1.
-        c.clauses[start - 1].size = cs;
-        // Set watch lists for non-unit clauses.
-        if (cs > 1) {
-            c.add_to_watchlist(start, c.clauses[start].lit);
-            c.add_to_watchlist(start, c.clauses[start+1].lit);
+        clause_t start = c->clauses.start_clause(cs);
+        for (lit_t x : lits) { c->clauses.push_back({x}); }
+        // Binary clauses go to the implication lists, anything longer gets
+        // watched.
+        if (cs == 2) {
+            c->add_bimps(start);
+        } else if (cs > 1) {
+            c->add_to_watchlist(start, c->clauses[start].lit);
+            c->add_to_watchlist(start, c->clauses[start+1].lit);
         }
     }
 
-    c.lemma_start = c.clauses.size() + kHeaderSize;
+    // Where the first lemma will land, accounting for alignment padding. (If
+    // an oversized first lemma gets bumped to a fresh chunk, the tombstone
+    // skip in for_each_clause_helper still finds it.)
+    c->lemma_start = c->clauses.fit(c->clauses.size() + kHeaderSize, 0);
     return c;
 }
 
@@ -779,23 +1714,28 @@ bool solve(Cnf* c) {
             // C5: [New level?]
 
             // If we've completed the trail without a conflict, we've found a
-            // satisfying assignment.
+            // satisfying assignment -- unless an assumption ended up false,
+            // in which case the formula is unsatisfiable under the
+            // assumptions (see the invariant note at the decision scan
+            // below: a false assumption means every decision on the trail is
+            // itself an assumption).
             if (!c->seen_conflict && c->trail_complete()) {
+                for (const lit_t a : c->assumptions) {
+                    if (c->is_false(a)) {
+                        LOG(2) << "Assumption " << a << " is contradicted.";
+                        return false;
+                    }
+                }
                 return true;
             }
 
-            // Is the clause database too big? If so, we need to evict some
-            // lemmas. Since our eviction heuristic is based on LBD, we'd like
-            // to schedule a full run before the eviction to compute levels for
-            // all variables. As soon as the full run is finished, we'll hit
-            // this code path again and actually reduce the database.
+            // Is the clause database too big? If so, evict some lemmas right
+            // away. Our eviction heuristic is based on the LBD stored in each
+            // lemma's header, so there's no need to complete a full run
+            // first, and reasons on the trail are pinned by reduce_db.
             size_t max_lemmas =
                 PARAM_max_lemmas + c->npurges * PARAM_max_lemmas_delta;
-            if (c->nlemmas >= max_lemmas && !c->trail_complete() &&
-                c->full_runs == 0) {
-                LOG(1) << "Clause database too big, scheduling a full run.";
-                c->full_runs = 1;
-            } else if (c->nlemmas >= max_lemmas && c->trail_complete()) {
+            if (c->nlemmas >= max_lemmas) {
                 LOG(1) << "Reducing clause database at epoch " << c->epoch
                        << ", starting size = " << c->nlemmas;
                 lc = c->reduce_db();
@@ -804,13 +1744,15 @@ bool solve(Cnf* c) {
                 INC(clause_database_purges);
             }
 
-            // Does our agility measure tell us that we're no longer making real
+            // Does our restart oracle tell us that we're no longer making real
             // progress in the search? If so, restart by jumping back to the
             // lowest level that we think will allow us to explore a different
             // search path. It wouldn't make much sense to restart in the middle
             // of a full run, since full runs are used for either computing
             // levels for all variables or warming up the heap activity stats.
-            if (c->agility.should_restart() && c->full_runs == 0) {
+            bool restart = PARAM_restart_policy == 1 ?
+                c->ema.should_restart() : c->agility.should_restart();
+            if (restart && c->full_runs == 0) {
                 lit_t dp = 0;
                 if (flip(PARAM_partial_restart_prob)) {
                     // Find unset var of max activity.
@@ -827,14 +1769,35 @@ bool solve(Cnf* c) {
                 }
 
                 if (dp < c->d) {
-                    LOG(1) << "Agility-driven restart at epoch " << c->epoch
+                    LOG(1) << "Oracle-driven restart at epoch " << c->epoch
                            << " (level " << c->d << " -> " << dp << ")";
                     c->backjump(dp);
                     c->full_runs = PARAM_warm_up_runs;
-                    INC(agility_restarts);
+                    INC(restarts);
+                    // A full restart is the one spot where the trail is
+                    // rewound and fully propagated, so vivify the lemmas that
+                    // survived the most recent database reduction here.
+                    if (PARAM_vivify_max_lbd > 0 && c->d == 0 &&
+                        c->npurges > c->vivify_purges) {
+                        c->vivify_purges = c->npurges;
+                        LOG(1) << "Vivifying lemmas at epoch " << c->epoch;
+                        if (!c->vivify()) {
+                            c->unsat = true;
+                            return false;
+                        }
+                        INC(vivification_passes);
+                    }
+                    // Pick up lemmas from other workers while the trail is
+                    // rewound. Imported clauses land after lc in the arena,
+                    // so lc is no longer the final clause and predecessor
+                    // subsumption must not truncate back to it.
+                    if (c->exchange != nullptr && c->d == 0) {
+                        c->import_shared();
+                        lc = clause_nil;
+                    }
                     continue;
                 } else {
-                    INC(aborted_agility_restarts);
+                    INC(aborted_restarts);
                 }
             }
 
@@ -849,22 +1812,47 @@ bool solve(Cnf* c) {
                 INC(full_runs);
             }
 
+            // Assumptions act as forced decisions at the lowest levels, so
+            // pick the first one that isn't satisfied yet as the next
+            // decision. If some assumption has become false, no assignment
+            // extends the assumptions: whenever an assumption is false or
+            // unassigned, every decision on the trail is itself an
+            // assumption (heap decisions only ever sit above a full stack of
+            // satisfied assumptions and are removed by any backjump that
+            // unassigns one), so the falsification doesn't depend on any
+            // heuristic choice. This scan has to run after the full-run
+            // cleanup above so the choice reflects the rewound trail.
+            lit_t al = lit_nil;
+            for (const lit_t a : c->assumptions) {
+                if (c->is_false(a)) {
+                    LOG(2) << "Assumption " << a << " is contradicted.";
+                    return false;
+                }
+                if (!c->is_true(a)) { al = a; break; }
+            }
+
             ++c->d;
             c->di[c->d] = c->trail.size();
 
             // C6: [Make a decision]
             INC(decisions);
-            bool peek = flip(PARAM_peek_prob);
-            lit_t k = peek ? c->heap.rpeek() : c->heap.delete_max();
-            while (c->val[k] != UNSET) {
-                k = peek ? c->heap.rpeek() : c->heap.delete_max();
-            }
-            CHECK(k != lit_nil) << "Got nil from heap::delete_max in step C6.";
-            LOG(3) << "Decided on variable " << k;
-            lit_t l = c->oval[k] == FALSE ? -k : k;
-            if (flip(PARAM_phase_flip_prob)) {
-                INC(forced_phase_flips);
-                l = -l;
+            lit_t l = al;
+            if (l != lit_nil) {
+                LOG(3) << "Assuming " << l;
+            } else {
+                bool peek = flip(PARAM_peek_prob);
+                lit_t k = peek ? c->heap.rpeek() : c->heap.delete_max();
+                while (c->val[k] != UNSET) {
+                    k = peek ? c->heap.rpeek() : c->heap.delete_max();
+                }
+                CHECK(k != lit_nil)
+                    << "Got nil from heap::delete_max in step C6.";
+                LOG(3) << "Decided on variable " << k;
+                l = c->oval[k] == FALSE ? -k : k;
+                if (flip(PARAM_phase_flip_prob)) {
+                    INC(forced_phase_flips);
+                    l = -l;
+                }
             }
             LOG(3) << "Adding " << l << " to the trail.";
             c->add_to_trail(l, clause_nil);
@@ -874,96 +1862,125 @@ bool solve(Cnf* c) {
         // We still have some literals on the trail at the current level whose
         // consequences haven't been explored. Explore them now.
         lit_t l = c->trail[c->next_trail_index++];
+        INC(propagations);
+        Phase prop_phase(PHASE_propagation);
         LOG(3) << "Examining " << -l << "'s watch list";
 
-        // Iterate through the clauses on -l's watchlist to see if there's a
-        // conflict. -l is now false, so we need to revisit its watchlist in the
-        // process: any clause on -l's watchlist that has some other non-false
-        // literal needs to be moved to that non-false literal's watchlist. Any
-        // clause that has no other non-false literal can stay on -l's
-        // watchlist. wlp tracks w's recomputed watchlist below.
+        // Scan -l's watcher vector to see if there's a conflict. -l is now
+        // false, so any entry whose blocking literal isn't true needs a
+        // closer look: if the clause has some other non-false literal, it
+        // moves to that literal's watchlist. A clause with no other non-false
+        // literal stays on -l's watchlist and either forces LIT1 or is a
+        // conflict. ri reads entries and wi writes back the entries that stay
+        // on -l's list.
         CHECK(c->is_false(-l)) << "Expected " << -l << " to be false.";
-        clause_t w = c->watch[-l];
-        clause_t* wlp = &c->watch[-l];
-        bool watchlist_conflict = false;
-        while (w != clause_nil) {
+        clause_t w = clause_nil;  // Conflict clause, if we find one.
+
+        // Binary clauses first: l's direct implications are a flat array of
+        // (literal, reason) pairs, so each one is either already true,
+        // forced, or a conflict -- no clause memory needs to be touched.
+        for (const Bimp& b : c->bimp[l]) {
+            if (c->is_true(b.l)) continue;
+            if (c->is_false(b.l)) {
+                LOG(3) << "Conflict in binary clause "
+                       << c->clause_debug_string(b.c);
+                w = b.c;
+                break;
+            }
+            LOG(3) << "Adding " << b.l << " to the trail, forced by "
+                   << c->clause_debug_string(b.c);
+            c->add_to_trail(b.l, b.c);
+        }
+
+        std::vector<Watcher>& wl = c->watch[-l];
+        size_t ri = 0, wi = 0;
+        for (; w == clause_nil && ri < wl.size(); ++ri) {
             // C4: [Does w force a unit?]
-            c->force_lit0(-l, w);
-            clause_t nw = c->WATCH0(w);
-            LOG(3) << "Looking at watched clause " << c->clause_debug_string(w)
+            if (c->is_true(wl[ri].blit)) {
+                // Fast path: the blocking literal is true, so the clause is
+                // satisfied and can't force anything. No need to load it.
+                wl[wi++] = wl[ri];
+                continue;
+            }
+            clause_t cw = wl[ri].c;
+            c->force_lit0(-l, cw);
+            LOG(3) << "Looking at watched clause " << c->clause_debug_string(cw)
                    << " to see if it forces a unit";
 
-            bool all_false = true;
+            if (c->is_true(c->LIT1(cw))) {
+                // The other watched literal is true: keep the entry here and
+                // cache that literal as the new blocking literal.
+                wl[wi++] = {cw, c->LIT1(cw)};
+                continue;
+            }
+
+            size_t nf = c->find_non_false(cw, 2);
+            bool all_false = nf == c->SIZE(cw);
             bool tombstones = false;
-            if (!c->is_true(c->LIT1(w))) {
-                for(size_t i = 2; i < c->SIZE(w); ++i) {
-                    // If we see a false literal from level zero, go ahead and
-                    // and remove it from the clause now by replacing it with a
-                    // tombstone (Ex. 268)
-                    lit_t ln = c->clauses[w + i].lit;
-                    if (PARAM_remove_level_0_false_lits == 1 &&
-                        c->is_false(ln) && c->lev[var(ln)] == 0) {
-                        c->clauses[w + i].lit = lit_nil;
+            if (PARAM_remove_level_0_false_lits == 1) {
+                // Everything before the first non-false literal is false, so
+                // the only thing left to check is which of those literals
+                // were falsified at level zero; those can be removed from
+                // the clause now by replacing them with a tombstone
+                // (Ex. 268).
+                for (size_t i = 2; i < nf; ++i) {
+                    if (c->lev[var(c->clauses[cw + i].lit)] == 0) {
+                        c->clauses[cw + i].lit = lit_nil;
                         tombstones = true;
-                        continue;
-                    } else if (!c->is_false(ln)) {
-                        all_false = false;
-                        LOG(3) << "Setting " << ln << " as the watched literal "
-                               << "in " << c->clause_debug_string(w);
-                        std::swap(c->LIT0(w), c->clauses[w + i].lit);
-                        c->add_to_watchlist(w, ln);
-                        break;
                     }
                 }
-                // Compact any tombstones we just added to the clause.
-                if (tombstones) {
-                    size_t j = 2;
-                    for(size_t i = 2; i < c->SIZE(w); ++i) {
-                        if (c->clauses[w+i].lit != lit_nil) {
-                            c->clauses[w+j].lit = c->clauses[w+i].lit;
-                            ++j;
-                        }
-                    }
-                    for(size_t i = j; i < c->SIZE(w); ++i) {
-                        c->clauses[w+i].lit = lit_nil;
+            }
+            if (!all_false) {
+                lit_t ln = c->clauses[cw + nf].lit;
+                LOG(3) << "Setting " << ln << " as the watched literal "
+                       << "in " << c->clause_debug_string(cw);
+                std::swap(c->LIT0(cw), c->clauses[cw + nf].lit);
+                c->add_to_watchlist(cw, ln);
+            }
+            // Compact any tombstones we just added to the clause.
+            if (tombstones) {
+                size_t j = 2;
+                for(size_t i = 2; i < c->SIZE(cw); ++i) {
+                    if (c->clauses[cw+i].lit != lit_nil) {
+                        c->clauses[cw+j].lit = c->clauses[cw+i].lit;
+                        ++j;
                     }
-                    INC(tombstoned_level_0_lits, c->SIZE(w) - j);
-                    c->clauses[w-1].size = j;
                 }
-
-                // If we only saw false literals, then it's up to LIT1: if it's
-                // free, it's now forced to be true so we can add it to the
-                // trail. If it's false, we've got a conflict. And if it's true,
-                // we can just move on.
-                if (all_false) {
-                    if (c->is_false(c->LIT1(w))) {
-                        LOG(3) << c->LIT1(w) << " false, entire clause false.";
-                        watchlist_conflict = true;
-                        break;
-                    } else { // l1 is free
-                        LOG(3) << "Adding " << c->LIT1(w) << " to the trail, "
-                               << "forced by " << c->clause_debug_string(w);
-                        c->add_to_trail(c->LIT1(w), w);
-                    }
+                for(size_t i = j; i < c->SIZE(cw); ++i) {
+                    c->clauses[cw+i].lit = lit_nil;
                 }
-
+                INC(tombstoned_level_0_lits, c->SIZE(cw) - j);
+                c->clauses[cw-1].size = j;
             }
 
-            if (all_false) {
-                // All literals in w except LIT1 are false. In this case, it's
-                // okay to keep w on -l's watchlist, since we need to track the
-                // clause and there's nowhere else to put it.
-                *wlp = w;
-                wlp = &(c->LIT0(w) == -l ? c->WATCH0(w) : c->WATCH1(w));
+            // If the clause moved to another literal's watchlist, just drop
+            // it from -l's list.
+            if (!all_false) continue;
+
+            // All literals in cw except LIT1 are false, so the clause has to
+            // stay on -l's watchlist: if LIT1 is free, it's now forced to be
+            // true so we can add it to the trail. If it's false, we've got a
+            // conflict.
+            wl[wi++] = {cw, c->LIT1(cw)};
+            if (c->is_false(c->LIT1(cw))) {
+                LOG(3) << c->LIT1(cw) << " false, entire clause false.";
+                w = cw;
+                ++ri;
+                break;
+            } else { // l1 is free
+                LOG(3) << "Adding " << c->LIT1(cw) << " to the trail, "
+                       << "forced by " << c->clause_debug_string(cw);
+                c->add_to_trail(c->LIT1(cw), cw);
             }
-
-            w = nw;
         }
 
-        // Finish surgery on -l's watchlist.
-        *wlp = w;
+        // Finish surgery on -l's watchlist: keep anything we didn't get to
+        // (non-empty only if we exited early on a conflict).
+        for (; ri < wl.size(); ++ri) { wl[wi++] = wl[ri]; }
+        wl.resize(wi);
+        prop_phase.stop();
 
-        if (!watchlist_conflict) {
+        if (w == clause_nil) {
             LOG(3) << "Didn't find conflict in " << -l << "'s watchlist.";
             continue;
         }
@@ -971,7 +1988,15 @@ bool solve(Cnf* c) {
         // C7: [Resolve a conflict]
         LOG(3) << "Found a conflict with d = " << c->d;
         c->seen_conflict = true;
-        if (c->d == 0) return false;
+        if (PARAM_telemetry_interval > 0 &&
+            ++c->nconflicts % static_cast<uint64_t>(
+                PARAM_telemetry_interval) == 0) {
+            c->print_telemetry();
+        }
+        if (c->d == 0) {
+            c->unsat = true;
+            return false;
+        }
 
         // Store the first conflict clause on each level. This is overkill if
         // we're not doing a full run, since there will only be one conflict.
@@ -983,6 +2008,7 @@ bool solve(Cnf* c) {
             continue;
         }
 
+        Phase analysis_phase(PHASE_conflict_analysis);
         lit_t dpmin = c->d;
         c->trail_lits.clear();
         while (c->confp > 0) {
@@ -1032,6 +2058,14 @@ bool solve(Cnf* c) {
                         LOG(2) << "Resolving: " << c->clause_debug_string(rc);
                         c->blit(rc, &r, &dp, &q);
 
+                        // A lemma that's being re-used as a reason is worth
+                        // keeping around, so refresh its stored LBD if the
+                        // current assignment gives a better one.
+                        if (rc >= c->lemma_start) {
+                            lit_t lbd = c->compute_lbd(rc);
+                            if (lbd < c->LBD(rc)) c->LBD(rc) = lbd;
+                        }
+
                         if (PARAM_on_the_fly_subsumption == 1 &&
                             q + r + 1 < c->clauses[rc-1].size && q > 0) {
                             // On-the-fly subsumption.
@@ -1053,14 +2087,13 @@ bool solve(Cnf* c) {
                             c->clauses[rc+li].lit = c->clauses[rc+len-1].lit;
                             c->clauses[rc+len-1].lit = lit_nil;
                             c->clauses[rc-1].size--;
-                            c->clauses[rc-2].ptr = c->watch[c->clauses[rc].lit];
-                            c->watch[c->clauses[rc].lit] = rc;
+                            c->add_to_watchlist(rc, c->clauses[rc].lit);
                             if (c->prooflog) {
+                                c->prooflog->start(false);
                                 for(size_t j = 0; j < c->SIZE(rc); ++j) {
-                                    fprintf(c->prooflog, "%d ",
-                                            c->clauses[rc+j].lit);
+                                    c->prooflog->lit(c->clauses[rc+j].lit);
                                 }
-                                fprintf(c->prooflog, "0\n");
+                                c->prooflog->end();
                             }
                             INC(on_the_fly_subsumptions);
                         }
@@ -1083,6 +2116,19 @@ bool solve(Cnf* c) {
                     ++rr;
                 }
                 INC(redundant_literals, r - rr);
+                if (static_cast<clause_t>(rr) < r) {
+                    // Without chronological backtracking this is a no-op:
+                    // every implied literal has a same-level reason
+                    // antecedent, so the chain of removals can never consume
+                    // all of level dp. A chrono-forced literal breaks that
+                    // invariant -- its reason lives entirely below its level
+                    // -- so removal can empty level dp and we have to
+                    // recompute the assertion level from the survivors.
+                    dp = 0;
+                    for (lit_t i = 0; i < rr; ++i) {
+                        dp = std::max(dp, c->lev[var(c->b[i])]);
+                    }
+                }
                 r = rr;
             }
 
@@ -1103,8 +2149,12 @@ bool solve(Cnf* c) {
 
                 if (q == 0 && c->val[var(c->clauses[lc].lit)] == UNSET) {
                     subsumed = true;
-                    c->remove_from_watchlist(lc, 0);
-                    c->remove_from_watchlist(lc, 1);
+                    if (c->SIZE(lc) == 2) {
+                        c->remove_bimps(lc);
+                    } else {
+                        c->remove_from_watchlist(lc, 0);
+                        c->remove_from_watchlist(lc, 1);
+                    }
                     c->clauses.resize(lc - kHeaderSize);
                     INC(subsumed_clauses);
                 }
@@ -1135,9 +2185,26 @@ bool solve(Cnf* c) {
             }
             dpmin = std::min(dpmin, dp);
         }
+        analysis_phase.stop();
 
         // C8: [Backjump]
-        c->backjump(dpmin);
+        // Chronological backtracking (Nadel and Ryvchin, SAT 2018): when the
+        // asserting level is far below the conflict level, unwinding all the
+        // way to dpmin discards propagation work that's often still valid.
+        // Backing off a single level instead is sound here: every clause in
+        // trail_lits has all of its non-asserting literals false at levels
+        // <= dpmin, so it stays unit at d - 1 and installing its asserting
+        // literal there in C9 is ordinary unit propagation.
+        // Unit clauses (dpmin == 0) are excepted: they have to reach level
+        // zero to become permanent, since a later backjump would unassign
+        // their literal and nothing would ever re-propagate it.
+        lit_t blevel = dpmin;
+        if (PARAM_chrono_backtrack_threshold > 0 && dpmin > 0 &&
+            c->d - dpmin > PARAM_chrono_backtrack_threshold) {
+            blevel = c->d - 1;
+            INC(chronological_backtracks);
+        }
+        c->backjump(blevel);
         c->seen_conflict = false;
 
         // C9: [Learn]
@@ -1161,11 +2228,66 @@ int main(int argc, char** argv) {
     init_counters();
     init_timers();
     Processor p(argv[oidx]);
-    Cnf c = parse(&p);
-    if (c.clauses.empty() || solve(&c)) {
-        SAT_EXIT(&c);
-    } else {
-        PRINT << "s UNSATISFIABLE" << std::endl;
-        return UNSATISFIABLE;
+
+    size_t workers = PARAM_workers;
+    if (workers <= 1) {
+        Cnf* c = parse(&p);
+        if (c->clauses.empty() || solve(c)) {
+            SAT_EXIT(c);
+        } else {
+            if (c->prooflog) c->prooflog->flush();
+            PRINT << "s UNSATISFIABLE" << std::endl;
+            return UNSATISFIABLE;
+        }
+    }
+
+    // Multi-worker mode: run several search instances concurrently, sharing
+    // short lemmas through a lock-free exchange buffer. The first worker to
+    // finish reports the result and exits the process.
+    CHECK(PARAM_share_size_limit <= ClauseExchange::kMaxLits)
+        << "share_size_limit must be at most " << ClauseExchange::kMaxLits;
+    if (FLAGS_dratfile != "") {
+        PRINT << "c DRAT logging disabled in multi-worker mode." << std::endl;
+        FLAGS_dratfile = "";
+    }
+    ClauseExchange* exchange = new ClauseExchange();
+#ifndef BAKED_PARAMS
+    double psi = PARAM_restart_sensitivity;
+#endif
+    unsigned long seed = FLAGS_seed;
+    std::vector<Cnf*> cs;
+    for (size_t i = 0; i < workers; ++i) {
+        // Diversify workers: each gets a differently shuffled heap and a
+        // perturbed restart sensitivity. (Params are constants in baked
+        // builds, so workers there differ by seed alone.)
+        if (seed != 0) FLAGS_seed = seed + i;
+#ifndef BAKED_PARAMS
+        PARAM_restart_sensitivity = psi * (1.0 + 0.05 * i);
+#endif
+        Cnf* c = parse(&p);
+        c->exchange = exchange;
+        c->worker_id = i;
+        cs.push_back(c);
+    }
+#ifndef BAKED_PARAMS
+    PARAM_restart_sensitivity = psi;
+#endif
+    FLAGS_seed = seed;
+
+    // Exactly one worker may report: two workers finishing close together
+    // would otherwise both print an s line and interleave their v lines
+    // before exit() tears the process down.
+    std::once_flag report;
+    std::vector<std::thread> threads;
+    for (Cnf* c : cs) {
+        threads.emplace_back([c, &report]{
+            if (c->clauses.empty() || solve(c)) {
+                std::call_once(report, [c]{ SAT_EXIT(c); });
+            } else {
+                std::call_once(report, []{ UNSAT_EXIT; });
+            }
+        });
     }
+    for (std::thread& t : threads) { t.join(); }
+    return UNKNOWN;
 }
@@ -0,0 +1,65 @@
+// Converts a DIMACS cnf input file into a binary snapshot that any of the
+// solvers can load near-instantly by mapping it instead of re-tokenizing the
+// text (see the snapshot format description in parse.h). Useful when the same
+// large instance will be solved repeatedly, e.g., with different seeds:
+//
+//   ./bin/cnfc big.cnf big.scnf
+//   ./bin/cdcl -s1 big.scnf
+//   ./bin/cdcl -s2 big.scnf
+
+#include <cstdio>
+#include <vector>
+
+#include "counters.h"
+#include "flags.h"
+#include "logging.h"
+#include "timer.h"
+#include "types.h"
+#include "parse.h"
+
+int main(int argc, char** argv) {
+    int oidx;
+    CHECK(parse_flags(argc, argv, &oidx)) <<
+        "Usage: " << argv[0] << " <input.cnf> <output.scnf>";
+    CHECK(oidx + 1 < argc) <<
+        "Usage: " << argv[0] << " <input.cnf> <output.scnf>";
+
+    DIMACS d(argv[oidx]);
+    d.reset();
+    std::vector<lit_t> lits;
+    std::vector<int64_t> start;
+    while (!d.eof()) {
+        std::size_t s = lits.size();
+        for (d.advance(); !d.eoc(); d.advance()) {
+            lits.push_back(d.curr());
+        }
+        if (d.eof() && s == lits.size()) break;
+        start.push_back(s);
+    }
+
+    snapshot_header_t h;
+    memcpy(h.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    h.lit_bytes = sizeof(lit_t);
+    h.pad = 0;
+    h.version = kSnapshotVersion;
+    h.nvars = d.nvars();
+    h.nclauses = start.size();
+    h.nlits = lits.size();
+
+    FILE* f = fopen(argv[oidx + 1], "w");
+    CHECK(f) << "Failed to open file: " << argv[oidx + 1];
+    CHECK(fwrite(&h, sizeof(h), 1, f) == 1)
+        << "Failed to write snapshot header.";
+    CHECK(start.empty() ||
+          fwrite(start.data(), sizeof(int64_t), start.size(), f) ==
+          start.size())
+        << "Failed to write clause-start index.";
+    CHECK(lits.empty() ||
+          fwrite(lits.data(), sizeof(lit_t), lits.size(), f) == lits.size())
+        << "Failed to write literal array.";
+    fclose(f);
+
+    PRINT << "c Wrote snapshot of " << start.size() << " clauses ("
+          << lits.size() << " literals) to " << argv[oidx + 1] << std::endl;
+    return 0;
+}
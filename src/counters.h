@@ -74,6 +74,18 @@ public:
         counts_.clear();
     }
 
+    // Sum of all increments applied to the named counter, or 0 if the counter
+    // was never touched. Used by the benchmark harness to pull out decision
+    // and propagation totals without scraping log output.
+    uint64_t total(const char* name) {
+        uint64_t sum = 0;
+        auto range = counts_.equal_range(name);
+        for (auto itr = range.first; itr != range.second; ++itr) {
+            sum += *itr->second.second;
+        }
+        return sum;
+    }
+
     static Counters& singleton() {
         static Counters s;
         return s;
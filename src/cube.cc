@@ -0,0 +1,174 @@
+// A cube-and-conquer solver combining the lookahead engine (look.cc) with a
+// pool of CDCL workers (cdcl.cc). The lookahead engine explores the top of
+// the search tree and emits a cube -- the partial assignment at the cutoff
+// point, see -pcube_depth and -pcube_free_vars -- whenever one of its
+// cutoffs is reached. CDCL workers consume cubes from a shared queue and
+// solve the formula under each cube as a set of assumptions, keeping their
+// learned clauses, heap activities, and saved phases warm from cube to
+// cube. The first worker to find a satisfying assignment wins and exits the
+// process; the instance is unsatisfiable once every emitted cube has been
+// refuted. A root-level conflict in any worker proves the whole formula
+// unsatisfiable immediately. The lookahead engine can also settle the
+// instance on its own while splitting: it exits directly if it stumbles on
+// a satisfying assignment, and an instance whose tree is exhausted with no
+// cubes emitted is unsatisfiable.
+
+// Standard headers used by the engines must be included here at top level so
+// their include guards keep them from being re-included inside the engine
+// namespaces below.
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "counters.h"
+#include "flags.h"
+#include "heap.h"
+#include "logging.h"
+#include "timer.h"
+#include "types.h"
+#include "params.h"
+#include "process.h"
+
+// Each engine below is compiled into its own namespace, exactly as in
+// portfolio.cc, so their Cnf structs, parse/solve functions, and params
+// don't collide. main is renamed per engine so the entry points don't
+// collide with ours (we never call them).
+
+// The engines' real main functions rely on falling off the end of main,
+// which is only legal for a function actually named main.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wreturn-type"
+
+#define main cdcl_main
+namespace cdcl {
+#include "cdcl.cc"
+}
+#undef main
+// cdcl.cc defines clause-layout macros that we don't want leaking into the
+// lookahead engine.
+#undef LIT0
+#undef LIT1
+#undef SIZE
+#undef WATCH0
+#undef WATCH1
+#undef PIN
+#undef LBD
+
+#define main look_main
+namespace look {
+#include "look.cc"
+}
+#undef main
+
+#pragma GCC diagnostic pop
+
+// Definition for a flag the CDCL engine declares extern inside its
+// namespace. DRAT logging stays disabled here: a proof would need to cover
+// the cube split as well as each worker's refutation.
+namespace cdcl { ::std::string FLAGS_dratfile = ""; }
+
+DEFINE_PARAM(cube_workers, 4,
+             "Number of CDCL worker threads conquering cubes.");
+
+// The cube queue, filled by the lookahead engine on the main thread and
+// drained by the CDCL workers. The instance is unsatisfiable once the
+// generator is done and every emitted cube has been refuted. The mutex,
+// condition variable, and queue are deliberately leaked: any engine may
+// call exit() from any thread (see SAT_EXIT/UNSAT_EXIT in logging.h), and
+// destroying a condition variable while other threads still wait on it
+// blocks forever.
+static std::mutex* const mu = new std::mutex;
+static std::condition_variable* const cv = new std::condition_variable;
+static std::deque<std::vector<lit_t>>* const cubes =
+    new std::deque<std::vector<lit_t>>;
+static bool done_generating = false;
+static size_t emitted = 0;
+static size_t refuted = 0;
+
+static void emit_cube(const std::vector<lit_t>& cube) {
+    std::unique_lock<std::mutex> lock(*mu);
+    cubes->push_back(cube);
+    ++emitted;
+    cv->notify_one();
+}
+
+// Worker loop: solve the formula under each cube until the queue is drained
+// and the generator is done. Exits the process on any definitive answer.
+static void conquer(cdcl::Cnf* c) {
+    while (true) {
+        std::vector<lit_t> cube;
+        {
+            std::unique_lock<std::mutex> lock(*mu);
+            cv->wait(lock, []{ return !cubes->empty() || done_generating; });
+            if (cubes->empty()) return;
+            cube = std::move(cubes->front());
+            cubes->pop_front();
+        }
+        LOG(1) << "Conquering a cube of " << cube.size() << " literals.";
+        if (c->d > 0) c->backjump(0);
+        c->seen_conflict = false;
+        c->assumptions = std::move(cube);
+        if (c->clauses.empty() || cdcl::solve(c)) SAT_EXIT(c);
+        if (c->unsat) UNSAT_EXIT;
+        c->assumptions.clear();
+        INC(cubes_refuted);
+        {
+            std::unique_lock<std::mutex> lock(*mu);
+            ++refuted;
+            cv->notify_all();
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    int oidx;
+    CHECK(parse_flags(argc, argv, &oidx)) <<
+        "Usage: " << argv[0] << " <filename>";
+    CHECK(PARAM_cube_workers >= 1) << "cube_workers must be >= 1";
+    CHECK(look::PARAM_stored_path_length >= 0)
+        << "stored_path_length must be >= 0";
+    CHECK(look::PARAM_stored_path_length <= 64)
+        << "stored_path_length must be <= 64";
+    init_counters();
+    init_timers();
+
+    // Parse once; the engines read sequentially here since Processor
+    // iteration is stateful. Each worker gets its own Cnf, like cdcl.cc's
+    // multi-worker mode.
+    Processor p(argv[oidx]);
+    size_t workers = PARAM_cube_workers;
+    std::vector<cdcl::Cnf*> cs;
+    for (size_t i = 0; i < workers; ++i) {
+        cs.push_back(cdcl::parse(&p));
+    }
+    look::Cnf lc = look::parse(&p);
+
+    look::cube_emit = emit_cube;
+    std::vector<std::thread> threads;
+    for (cdcl::Cnf* c : cs) {
+        threads.emplace_back(conquer, c);
+    }
+
+    // Generate cubes on this thread. The lookahead engine exits the process
+    // itself if it finds a satisfying assignment while splitting; a false
+    // return just means the tree is exhausted.
+    if (look::solve(&lc)) SAT_EXIT(&lc);
+    LOG(1) << "Cube generation done: " << emitted << " cubes emitted.";
+
+    // All cubes are out; wait for the workers to refute every last one.
+    {
+        std::unique_lock<std::mutex> lock(*mu);
+        done_generating = true;
+        cv->notify_all();
+        cv->wait(lock, []{ return refuted == emitted; });
+    }
+    UNSAT_EXIT;
+}
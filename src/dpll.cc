@@ -6,10 +6,16 @@
 #include "counters.h"
 #include "flags.h"
 #include "logging.h"
+#include "params.h"
 #include "timer.h"
 #include "types.h"
 #include "process.h"
 
+DEFINE_PARAM(unit_queue, 1,
+             "If 1, detect unit clauses with a propagation queue over "
+             "two-literal watch lists instead of re-deriving unit status by "
+             "scanning the active ring, which can be quadratic per step.");
+
 enum State {
     UNSET = 0,
     FALSE = 1,           // Trying false, haven't tried true yet.
@@ -75,6 +81,25 @@ struct Cnf {
     // One-indexed current (partial) permutation of explored variables.
     std::vector<lit_t> heads;
 
+    // State for the unit-propagation queue mode (see solve_queue). qwatch
+    // maps a literal to the clauses watching it; each clause watches its
+    // first two literals, cdcl-style, instead of the single watched literal
+    // the active ring uses. Like watch above, qwatch points at the middle of
+    // its storage so it accepts negated variables as indexes.
+    std::vector<std::vector<clause_t>> qwatch_storage;
+    std::vector<clause_t>* qwatch;
+
+    // The trail of literals currently set true, in the order they were set.
+    // Literals before next_trail_index have had their consequences explored;
+    // the rest form the FIFO of pending propagations. di[s] is the trail
+    // index of stage s's decision literal.
+    std::vector<lit_t> trail;
+    size_t next_trail_index;
+    std::vector<size_t> di;
+
+    // No variable below free_hint is unset, so decision scans start there.
+    lit_t free_hint;
+
     Cnf(Processor* p) :
         p(p),
         nvars(p->nvars()),
@@ -85,7 +110,10 @@ struct Cnf {
         head(lit_nil),
         tail(lit_nil),
         val(nvars + 1, UNSET),
-        heads(nvars + 1, lit_nil) {}
+        heads(nvars + 1, lit_nil),
+        qwatch(nullptr),
+        next_trail_index(0),
+        free_hint(1) {}
 
     // These two methods give the begin/end index of the kth clause in the
     // clauses vector. Used for iterating over all literals in the kth clause.
@@ -105,6 +133,51 @@ struct Cnf {
         return (x > 0 && s & 1) || (x < 0 && s > 0 && !(s & 1));
     }
 
+    // Is the literal x currently true?
+    inline bool is_true(lit_t x) const {
+        State s = val[var(x)];
+        return (x > 0 && s > 0 && !(s & 1)) || (x < 0 && s & 1);
+    }
+
+    // Queue mode: appends a forced literal to the trail.
+    void add_to_trail(lit_t l) {
+        val[var(l)] = l > 0 ? TRUE_FORCED : FALSE_FORCED;
+        trail.push_back(l);
+    }
+
+    // Queue mode: unwinds the trail to the start of stage s, unassigning the
+    // stage's decision and everything forced after it.
+    void pop_stage(lit_t s) {
+        while (trail.size() > di[s]) {
+            lit_t k = var(trail.back());
+            trail.pop_back();
+            val[k] = UNSET;
+            if (k < free_hint) free_hint = k;
+        }
+        next_trail_index = trail.size();
+    }
+
+    // Queue mode: builds watch lists over the first two literals of each
+    // clause and enqueues the input's unit clauses, which are permanently
+    // forced. Returns false if two input units contradict each other.
+    bool init_queue() {
+        qwatch_storage.resize(2 * nvars + 1);
+        qwatch = &qwatch_storage[nvars];
+        trail.reserve(nvars);
+        di.resize(nvars + 1, 0);
+        for (clause_t j = 0; j < start.size(); ++j) {
+            clause_t b = clause_begin(j);
+            if (clause_end(j) - b == 1) {
+                if (is_false(clauses[b])) return false;
+                if (!is_true(clauses[b])) add_to_trail(clauses[b]);
+                continue;
+            }
+            qwatch[clauses[b]].push_back(j);
+            qwatch[clauses[b + 1]].push_back(j);
+        }
+        return true;
+    }
+
     // Is there any freedom to set the variable we chose at stage d to some
     // other value? The only way this is possible is if that variable hasn't
     // been explored yet or only true/false has been tried and the other value
@@ -196,8 +269,110 @@ Cnf parse(Processor* p) {
     return c;
 }
 
+// Queue mode: propagates every pending trail literal in FIFO order, doing
+// watch-list surgery along the way. Returns false exactly when a clause
+// becomes false under the current assignment.
+bool propagate(Cnf* c) {
+    while (c->next_trail_index < c->trail.size()) {
+        lit_t l = c->trail[c->next_trail_index++];
+        LOG(3) << "Examining " << -l << "'s watch list";
+        std::vector<clause_t>& wl = c->qwatch[-l];
+        size_t ri = 0, wi = 0;
+        bool conflict = false;
+        for (; !conflict && ri < wl.size(); ++ri) {
+            clause_t j = wl[ri];
+            clause_t b = c->clause_begin(j);
+            // Make sure the false literal -l sits in the second watch slot.
+            if (c->clauses[b] == -l) {
+                std::swap(c->clauses[b], c->clauses[b + 1]);
+            }
+            if (c->is_true(c->clauses[b])) {
+                // The other watched literal is true: clause is satisfied.
+                wl[wi++] = j;
+                continue;
+            }
+            clause_t p = b + 2;
+            clause_t e = c->clause_end(j);
+            while (p < e && c->is_false(c->clauses[p])) { ++p; }
+            if (p < e) {
+                // Found a non-false literal to watch instead of -l.
+                std::swap(c->clauses[b + 1], c->clauses[p]);
+                c->qwatch[c->clauses[b + 1]].push_back(j);
+                continue;
+            }
+            // Everything but the other watched literal is false, so the
+            // clause either forces that literal or is a conflict.
+            wl[wi++] = j;
+            if (c->is_false(c->clauses[b])) {
+                LOG(3) << "Conflict: clause " << j << " is false";
+                conflict = true;
+            } else {
+                INC(propagations);
+                LOG(3) << "Adding " << c->clauses[b]
+                       << " to the trail, forced by clause " << j;
+                c->add_to_trail(c->clauses[b]);
+            }
+        }
+        for (; ri < wl.size(); ++ri) { wl[wi++] = wl[ri]; }
+        wl.resize(wi);
+        if (conflict) return false;
+    }
+    return true;
+}
+
+// Queue-mode search: the same stages, value states, and backtracking as the
+// active ring version below, but with units discovered by the propagation
+// queue instead of re-derived by scanning the ring, so each trail literal is
+// examined once per stage instead of once per is_unit call.
+bool solve_queue(Cnf* c) {
+    Timer t("solve");
+    if (!c->init_queue()) return false;
+    lit_t d = 0;
+
+    while (true) {
+        LOG(1) << "val: " << c->val_debug_string();
+        if (!propagate(c)) {
+            LOG(2) << "Backtracking from " << d;
+            // Backtrack until we find a variable that has another truth
+            // value we can try.
+            while (d > 0 && !c->freedom_at_stage(d)) {
+                LOG(2) << "  Unsetting stage " << d;
+                c->pop_stage(d);
+                --d;
+            }
+            // If we've backtracked to the start, formula is unsatisfiable.
+            if (d <= 0) return false;
+            // Otherwise, try the other truth value for step d > 0.
+            lit_t k = c->heads[d];
+            State s = c->val[k];
+            c->pop_stage(d);
+            c->val[k] = s == TRUE ? FALSE_NOT_TRUE : TRUE_NOT_FALSE;
+            c->trail.push_back(c->val[k] & 1 ? -k : k);
+            continue;
+        }
+        if (c->trail.size() == static_cast<size_t>(c->nvars)) return true;
+
+        // No units pending and no conflict: branch on the lowest unset
+        // variable, guessing TRUE/FALSE based on the watch lists the way the
+        // ring version does.
+        INC(decisions);
+        while (c->val[c->free_hint] != UNSET) { ++c->free_hint; }
+        lit_t k = c->free_hint;
+        ++d;
+        c->heads[d] = k;
+        c->di[d] = c->trail.size();
+        if (c->qwatch[k].empty() || !c->qwatch[-k].empty()) {
+            c->val[k] = TRUE;
+        } else {
+            c->val[k] = FALSE;
+        }
+        LOG(2) << "Branching on " << k << " = " << c->val[k];
+        c->trail.push_back(c->val[k] & 1 ? -k : k);
+    }
+}
+
 // Returns true exactly when a satisfying assignment exists for c.
-bool solve(Cnf* c) {
+bool solve_ring(Cnf* c) {
     Timer t("solve");
 
     // The search for a satisfying assignment proceeds in stages from d = 1 to
@@ -251,11 +426,13 @@ bool solve(Cnf* c) {
                 break;
             } else if (pos_unit) {
                 // Only the positive form of the variable appears in a unit.
+                INC(propagations);
                 c->val[c->head] = TRUE_FORCED;
                 c->tail = k;
                 break;
             } else if (neg_unit) {
                 // Only the negated form of the variable appears in a unit.
+                INC(propagations);
                 c->val[c->head] = FALSE_FORCED;
                 c->tail = k;
                 break;
@@ -270,6 +447,7 @@ bool solve(Cnf* c) {
         // state of the watch list, but it's only a guess -- we may end up
         // backtracking and trying the other value later.
         if (!pos_unit && !neg_unit) {
+            INC(decisions);
             LOG(2) << "Couldn't find a unit clause, resorting to branching";
             c->head = c->next[c->tail];
             if (!c->watched(c->head) || c->watched(-c->head)) {
@@ -342,6 +520,12 @@ bool solve(Cnf* c) {
     return true;
 }
 
+// Returns true exactly when a satisfying assignment exists for c.
+bool solve(Cnf* c) {
+    if (PARAM_unit_queue == 1) return solve_queue(c);
+    return solve_ring(c);
+}
+
 int main(int argc, char** argv) {
     int oidx;
     CHECK(parse_flags(argc, argv, &oidx)) <<
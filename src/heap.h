@@ -35,9 +35,16 @@ struct Heap {
     Heap(lit_t nvars, size_t D=PARAM_heap_d) :
     hloc(nvars + 1, kHeapNil),
       key(nvars + 1, 0.0),
+#ifndef BAKED_PARAMS
       D(D),
+#endif
       delta(1.0),
       max_key(kNegInf) {
+#ifdef BAKED_PARAMS
+        // The branching factor is a compile-time constant in baked builds;
+        // requests for a different one are ignored.
+        (void)D;
+#endif
     }
 
     // Initialize heap for CDCL by adding all vars and shuffling their order.
@@ -80,6 +87,32 @@ struct Heap {
         siftup(heap.size() - 1);
     }
 
+    // Inserts every var in vs, restoring the heap property once at the end
+    // instead of sifting up per insert. Small batches still sift up, since a
+    // bottom-up heapify pass costs time proportional to the whole heap; for
+    // large batches (deep backjumps, restarts) the single bottom-up pass is
+    // O(n) with sequential access instead of O(n log n) sift-ups.
+    void bulk_insert(const std::vector<lit_t>& vs) {
+        size_t before = heap.size();
+        for (lit_t v : vs) {
+            if (hloc[v] != kHeapNil) continue;
+            hloc[v] = heap.size();
+            heap.push_back(v);
+        }
+        size_t added = heap.size() - before;
+        if (added == 0) return;
+        if (added < heap.size() / D) {
+            for (size_t i = before; i < heap.size(); ++i) {
+                siftup(i);
+            }
+            return;
+        }
+        if (heap.size() < 2) return;
+        for (size_t i = (heap.size() - 2) / D + 1; i-- > 0; ) {
+            siftdown(i);
+        }
+    }
+
     lit_t delete_max() {
         if (heap.empty()) return lit_nil;
         hloc[heap[0]] = kHeapNil;
@@ -139,7 +172,7 @@ struct Heap {
         if (i == 0 || i == kHeapNil) return;
         lit_t v = heap[i];
         size_t p = (i - 1) / D;
-        while (key[heap[p]] < key[heap[i]]) {
+        while (key[heap[p]] < key[v]) {
             heap[i] = heap[p];
             hloc[heap[i]] = i;
             i = p;
@@ -198,7 +231,13 @@ struct Heap {
     std::vector<size_t> hloc; // kHeapNil == nil, hloc is 1-indexed.
     std::vector<lit_t> heap;  // heap is 0-indexed.
     std::vector<double> key;  // key is 1-indexed
+#ifdef BAKED_PARAMS
+    // A compile-time branching factor lets the divisions in the sift
+    // operations fold to shifts.
+    static constexpr size_t D = static_cast<size_t>(PARAM_heap_d);
+#else
     const size_t D;
+#endif
     double delta;
     double max_key;
 };
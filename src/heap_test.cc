@@ -130,6 +130,44 @@ TEST(insert_from_empty,
      EXPECT_EQ(h.delete_max(), lit_nil);
     )
 
+TEST(bulk_insert_small_batch,
+     // A batch much smaller than the heap takes the sift-up path.
+     Heap h(100, 2);
+     for (lit_t i = 1; i <= 100; ++i) { h.insert(i, i); }
+     EXPECT_EQ(h.delete_max(), 100);
+     EXPECT_EQ(h.delete_max(), 99);
+     std::vector<lit_t> vs;
+     vs.push_back(99);
+     vs.push_back(100);
+     h.bulk_insert(vs);
+     for (lit_t i = 100; i >= 1; --i) { EXPECT_EQ(h.delete_max(), i); }
+     EXPECT_EQ(h.delete_max(), lit_nil);
+    )
+
+TEST(bulk_insert_rebuild,
+     // A batch comparable to the heap takes the bottom-up heapify path.
+     Heap h(100, 2);
+     std::vector<lit_t> vs;
+     for (lit_t i = 1; i <= 100; ++i) { vs.push_back(i); }
+     for (lit_t i = 1; i <= 100; ++i) { h.insert(i, i); }
+     for (lit_t i = 1; i <= 100; ++i) { h.delete_max(); }
+     h.bulk_insert(vs);
+     for (lit_t i = 100; i >= 1; --i) { EXPECT_EQ(h.delete_max(), i); }
+     EXPECT_EQ(h.delete_max(), lit_nil);
+    )
+
+TEST(bulk_insert_skips_present,
+     Heap h(10, 2);
+     h.insert(5, 50);
+     std::vector<lit_t> vs;
+     vs.push_back(5);
+     vs.push_back(7);
+     vs.push_back(3);
+     h.bulk_insert(vs);
+     EXPECT_EQ(h.size(), 3u);
+     EXPECT_EQ(h.delete_max(), 5);
+    )
+
 TEST(avg,
      Heap h(10, 3);
      h.insert(7, 100);
@@ -154,5 +192,8 @@ int main(int argc, char **argv) {
     RUN(multiple_bumps_4);
     RUN(empty);
     RUN(insert_from_empty);
+    RUN(bulk_insert_small_batch);
+    RUN(bulk_insert_rebuild);
+    RUN(bulk_insert_skips_present);
     RUN(avg);
 }
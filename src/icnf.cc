@@ -0,0 +1,70 @@
+// A driver for the incremental CDCL interface (incremental.h) that reads
+// the "p inccnf" format: DIMACS clause lines interleaved with assumption
+// lines of the form "a <lit> ... <lit> 0". Each assumption line triggers a
+// solve of the clauses read so far under those assumptions, and an "s"
+// result line is printed per solve. A file with no assumption lines is
+// solved once at end of input, like a plain CNF file.
+//
+// Since the inccnf header carries no variable count, the file is scanned
+// once up front to find the largest variable mentioned.
+
+#include <fstream>
+#include <string>
+
+#include "incremental.h"
+
+int main(int argc, char** argv) {
+    int oidx;
+    CHECK(parse_flags(argc, argv, &oidx)) <<
+        "Usage: " << argv[0] << " <filename>";
+    init_counters();
+    init_timers();
+
+    lit_t nvars = 0;
+    {
+        std::ifstream in(argv[oidx]);
+        CHECK(!in.fail()) << "Error opening file " << argv[oidx];
+        std::string tok;
+        while (in >> tok) {
+            if (tok == "c" || tok == "p") {
+                std::string rest;
+                std::getline(in, rest);
+                continue;
+            }
+            if (tok == "a") continue;
+            lit_t l = strtol(tok.c_str(), nullptr, 10);
+            nvars = std::max(nvars, abs(l));
+        }
+    }
+    LOG(1) << "Largest variable in input: " << nvars;
+
+    Solver s(nvars);
+    int result = UNKNOWN;
+    size_t nsolves = 0;
+    std::ifstream in(argv[oidx]);
+    CHECK(!in.fail()) << "Error opening file " << argv[oidx];
+    std::string tok;
+    while (in >> tok) {
+        if (tok == "c" || tok == "p") {
+            std::string rest;
+            std::getline(in, rest);
+            continue;
+        }
+        if (tok == "a") {
+            lit_t l;
+            while (in >> l && l != lit_nil) { s.assume(l); }
+            result = s.solve();
+            ++nsolves;
+            PRINT << (result == SATISFIABLE ?
+                      "s SATISFIABLE" : "s UNSATISFIABLE") << std::endl;
+            continue;
+        }
+        s.add(strtol(tok.c_str(), nullptr, 10));
+    }
+    if (nsolves == 0) {
+        result = s.solve();
+        PRINT << (result == SATISFIABLE ?
+                  "s SATISFIABLE" : "s UNSATISFIABLE") << std::endl;
+    }
+    return result;
+}
@@ -0,0 +1,130 @@
+#ifndef __INCREMENTAL_H__
+#define __INCREMENTAL_H__
+
+// An IPASIR-style incremental interface to the CDCL engine (cdcl.cc):
+// add clauses, push assumptions, solve, read off the model, repeat. The
+// point of going through this interface instead of running bin/cdcl once
+// per query is that everything the engine accumulates during a solve --
+// learned clauses, variable activities in the heap, and saved phases --
+// stays warm across calls, which matters a lot for workloads that issue
+// many near-identical queries over one base formula.
+//
+// Assumptions hold for a single solve() call, as in IPASIR. Clauses may be
+// added at any time between calls; clauses and assumptions may only mention
+// variables declared up front via the Solver constructor.
+//
+// cdcl.cc is compiled into a namespace here, just like src/portfolio.cc
+// does, so this header can only be included from one translation unit per
+// binary. Standard headers used by the engine must be included before the
+// namespace below so their include guards keep them from being re-included
+// inside it.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "counters.h"
+#include "flags.h"
+#include "heap.h"
+#include "logging.h"
+#include "timer.h"
+#include "types.h"
+#include "params.h"
+#include "process.h"
+
+// The engine's real main relies on falling off the end of main, which is
+// only legal for a function actually named main.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wreturn-type"
+
+#define main cdcl_main
+namespace cdcl {
+#include "cdcl.cc"
+}
+#undef main
+// cdcl.cc defines clause-layout macros that shouldn't leak to our includer.
+#undef LIT0
+#undef LIT1
+#undef SIZE
+#undef WATCH0
+#undef WATCH1
+#undef PIN
+#undef LBD
+
+#pragma GCC diagnostic pop
+
+// Definition for a flag the engine declares extern inside its namespace.
+// DRAT logging isn't meaningful across incremental queries, since clauses
+// added between calls have no proof-level justification.
+namespace cdcl { ::std::string FLAGS_dratfile = ""; }
+
+class Solver {
+  public:
+    // Constructs a solver over variables 1..nvars.
+    explicit Solver(lit_t nvars) :
+        c_(static_cast<size_t>(nvars)),
+        model_(nvars + 1, false),
+        unsat_(false) {}
+
+    // Adds a literal to the clause under construction, or finishes and
+    // installs the clause if l is zero.
+    void add(lit_t l) {
+        if (l != lit_nil) {
+            clause_.push_back(l);
+            return;
+        }
+        if (unsat_) { clause_.clear(); return; }
+        // Rewind to the root first. backjump(0) is only meaningful above
+        // level 0: before the first decision di[1] hasn't been set, and
+        // rewinding would strip level-0 units off the trail.
+        if (c_.d > 0) c_.backjump(0);
+        if (!c_.add_clause(clause_)) unsat_ = true;
+        clause_.clear();
+    }
+
+    // Assumes l is true for the next solve() call only.
+    void assume(lit_t l) { assumptions_.push_back(l); }
+
+    // Solves the current formula under the current assumptions. Returns
+    // SATISFIABLE or UNSATISFIABLE.
+    int solve() {
+        bool sat = false;
+        if (!unsat_) {
+            if (c_.d > 0) c_.backjump(0);
+            c_.seen_conflict = false;
+            c_.assumptions.swap(assumptions_);
+            sat = cdcl::solve(&c_);
+            c_.assumptions.clear();
+            if (sat) {
+                for (size_t i = 1; i <= c_.nvars; ++i) {
+                    model_[i] = c_.val[i] != cdcl::UNSET && !(c_.val[i] & 1);
+                }
+            }
+            unsat_ = c_.unsat;
+        }
+        assumptions_.clear();
+        return sat ? SATISFIABLE : UNSATISFIABLE;
+    }
+
+    // The value of literal l in the model found by the last successful
+    // solve() call.
+    bool value(lit_t l) const {
+        return l > 0 ? model_[l] : !model_[-l];
+    }
+
+  private:
+    cdcl::Cnf c_;
+    std::vector<lit_t> clause_;
+    std::vector<lit_t> assumptions_;
+    std::vector<bool> model_;
+    bool unsat_;
+};
+
+#endif  // __INCREMENTAL_H__
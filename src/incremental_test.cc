@@ -0,0 +1,110 @@
+#include "incremental.h"
+
+#define EXPECT_EQ(x,y) if ((x) != (y)) { LOG(0) << #x << " != " << #y; }
+#define TEST(x,y) static void test_##x() \
+    { LOG(1) << "--------- Running " << __func__ << " ---------" ; y \
+      LOG(3) << "--------- Finished " << __func__ << " ---------"; }
+#define RUN(x) test_##x()
+
+TEST(basic_sat,
+     Solver s(2);
+     s.add(1); s.add(2); s.add(0);
+     EXPECT_EQ(s.solve(), SATISFIABLE);
+     EXPECT_EQ(s.value(1) || s.value(2), true);
+    )
+
+TEST(basic_unsat,
+     Solver s(1);
+     s.add(1); s.add(0);
+     s.add(-1); s.add(0);
+     EXPECT_EQ(s.solve(), UNSATISFIABLE);
+     // Root-level unsatisfiability is permanent.
+     EXPECT_EQ(s.solve(), UNSATISFIABLE);
+    )
+
+TEST(units_fix_model,
+     Solver s(3);
+     s.add(1); s.add(0);
+     s.add(-2); s.add(0);
+     s.add(-1); s.add(2); s.add(3); s.add(0);
+     EXPECT_EQ(s.solve(), SATISFIABLE);
+     EXPECT_EQ(s.value(1), true);
+     EXPECT_EQ(s.value(-2), true);
+     EXPECT_EQ(s.value(3), true);
+    )
+
+TEST(assumptions_one_call,
+     Solver s(2);
+     s.add(1); s.add(2); s.add(0);
+     s.assume(-1);
+     s.assume(-2);
+     EXPECT_EQ(s.solve(), UNSATISFIABLE);
+     // Assumptions only hold for a single call.
+     EXPECT_EQ(s.solve(), SATISFIABLE);
+     s.assume(-1);
+     EXPECT_EQ(s.solve(), SATISFIABLE);
+     EXPECT_EQ(s.value(-1), true);
+     EXPECT_EQ(s.value(2), true);
+    )
+
+TEST(assumption_flips,
+     // Both polarities of every variable work as assumptions against the
+     // same warm solver state.
+     Solver s(4);
+     s.add(1); s.add(2); s.add(3); s.add(0);
+     s.add(-1); s.add(-2); s.add(0);
+     s.add(-3); s.add(4); s.add(0);
+     for (lit_t v = 1; v <= 4; ++v) {
+         s.assume(v);
+         EXPECT_EQ(s.solve(), SATISFIABLE);
+         EXPECT_EQ(s.value(v), true);
+         s.assume(-v);
+         EXPECT_EQ(s.solve(), SATISFIABLE);
+         EXPECT_EQ(s.value(-v), true);
+     }
+    )
+
+TEST(add_after_solve,
+     Solver s(3);
+     s.add(1); s.add(2); s.add(0);
+     EXPECT_EQ(s.solve(), SATISFIABLE);
+     s.add(-1); s.add(3); s.add(0);
+     s.add(-2); s.add(3); s.add(0);
+     s.assume(-3);
+     EXPECT_EQ(s.solve(), UNSATISFIABLE);
+     EXPECT_EQ(s.solve(), SATISFIABLE);
+     EXPECT_EQ(s.value(3), true);
+     s.add(-3); s.add(0);
+     EXPECT_EQ(s.solve(), UNSATISFIABLE);
+    )
+
+TEST(pigeonhole,
+     // Three pigeons, two holes: var 2*(p-1)+h means pigeon p is in hole h.
+     Solver s(6);
+     for (int p = 0; p < 3; ++p) {
+         s.add(2*p + 1); s.add(2*p + 2); s.add(0);
+     }
+     for (int h = 1; h <= 2; ++h) {
+         for (int p = 0; p < 3; ++p) {
+             for (int q = p + 1; q < 3; ++q) {
+                 s.add(-(2*p + h)); s.add(-(2*q + h)); s.add(0);
+             }
+         }
+     }
+     EXPECT_EQ(s.solve(), UNSATISFIABLE);
+    )
+
+int main(int argc, char **argv) {
+    int oidx;
+    CHECK(parse_flags(argc, argv, &oidx)) <<
+        "Usage: " << argv[0] << " <filename>";
+
+    LOG(0) << "Running all tests. No output below means everything passes.";
+    RUN(basic_sat);
+    RUN(basic_unsat);
+    RUN(units_fix_model);
+    RUN(assumptions_one_call);
+    RUN(assumption_flips);
+    RUN(add_after_solve);
+    RUN(pigeonhole);
+}
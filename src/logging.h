@@ -33,8 +33,11 @@ extern int FLAGS_verbosity;
     if (VARNAME(__log, __LINE__)) Logger(__FILE__,__LINE__)
 #define CHECK(expr) if (!(expr)) AbortLogger(__FILE__,__LINE__)
 #define CHECK_NO_OVERFLOW(x, y) \
-    CHECK(std::numeric_limits<x>::min() <= (y) &&  \
-          std::numeric_limits<x>::max() >= (y)) << \
+    CHECK((y) >= 0 ? \
+          static_cast<uintmax_t>(y) <= \
+              static_cast<uintmax_t>(std::numeric_limits<x>::max()) : \
+          static_cast<intmax_t>(y) >= \
+              static_cast<intmax_t>(std::numeric_limits<x>::min())) << \
     "Overflow/underflow detected setting variable of type " << #x \
     << ": " << #y << " = " << y << ". "
 #define UNSAT_EXIT UnsatExit()
@@ -16,6 +16,7 @@
 //   - Exercise 169: Use Ahmed-Kullmann heuristic for choosing branch literal
 
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #include "counters.h"
@@ -64,6 +65,12 @@ DEFINE_PARAM(disable_lookahead_wraparound, 0,
              "If 1, during lookahead, don't wait until propagation stops, only "
              "iterate through lookahead candidates at most once.");
 
+DEFINE_PARAM(lookahead_threads, 1,
+             "If > 1, score lookahead candidates on this many threads using "
+             "private truth stamps, merging scores before branching. The "
+             "parallel pass skips double lookahead, windfalls, and autarky "
+             "exploitation and doesn't iterate to a fixed point.");
+
 DEFINE_PARAM(add_windfalls, 1.0,
              "If 1, generate 'windfall' binary clauses during lookahead that "
              "are implied by consequences of the current lookahead literal.");
@@ -107,6 +114,17 @@ DEFINE_PARAM(use_advanced_branch_heuristic, 0,
              "If 1, use the heuristic of T. Ahmed and O. Kullmann to choose "
              "a branch variable.");
 
+// Cutoffs for cube generation. These only take effect when solve() runs as
+// a cube generator for the cube-and-conquer driver (cube.cc); bin/look
+// ignores them.
+DEFINE_PARAM(cube_depth, 10,
+             "When generating cubes, emit a cube and backtrack once the "
+             "search reaches this depth. 0 disables the depth cutoff.");
+
+DEFINE_PARAM(cube_free_vars, 0,
+             "When generating cubes, emit a cube and backtrack once at most "
+             "this many variables remain free. 0 disables this cutoff.");
+
 // 32-bit truth stamps form the basis of the data structure used to efficiently
 // set and forget truth values during lookahead. The solver always carries a
 // 32-bit truth context t. Any literal with an even truth stamp >= t is true
@@ -717,6 +735,7 @@ bool propagate(Cnf* c, lit_t l) {
     }
     for(; h < c->rstack.size(); ++h) {
         l = c->rstack[h];
+        INC(propagations);
         for (lit_t lp : c->bimp[l]) {
             if (c->fixed_false(lp)) {
                 return false;
@@ -729,6 +748,24 @@ bool propagate(Cnf* c, lit_t l) {
     return true;
 }
 
+// Cube-and-conquer support, used by the cube driver (cube.cc): when
+// cube_emit is non-null, solve() runs as a cube generator. Whenever one of
+// the cutoffs above is hit, the current partial assignment (restricted to
+// original variables, since auxiliary 3-SAT variables mean nothing to other
+// engines) is handed to cube_emit and the branch is abandoned as if it had
+// been refuted, so the emitted cubes cover the entire unrefuted search
+// space. solve() then returns false once the tree is exhausted instead of
+// claiming unsatisfiability, since emitted cubes may still be satisfiable.
+static void (*cube_emit)(const std::vector<lit_t>&) = nullptr;
+static bool cube_done = false;
+
+static bool cube_cutoff(Cnf* c) {
+    if (cube_emit == nullptr) return false;
+    if (PARAM_cube_depth > 0 && c->d >= PARAM_cube_depth) return true;
+    return PARAM_cube_free_vars > 0 &&
+        c->freevar.size() <= PARAM_cube_free_vars;
+}
+
 // Reset after a conflict has been detected. If we're trying a literal and
 // haven't tried its negation yet, we'll negate and proceed. Otherwise, we'll
 // backtrack. Returns next literal we should try. This is L11 - L15 in the text.
@@ -766,7 +803,13 @@ lit_t resolve_conflict(Cnf* c) {
         }
 
         // L15. [Backtrack.]
-        if (c->d == 0) UNSAT_EXIT;
+        if (c->d == 0) {
+            // In cube generation mode an exhausted tree isn't a refutation:
+            // the emitted cubes may still be satisfiable. Tell solve() to
+            // stop instead of exiting.
+            if (cube_emit != nullptr) { cube_done = true; return lit_nil; }
+            UNSAT_EXIT;
+        }
         --c->d;
         c->rstack.resize(c->f);
         c->f = c->backf[c->d];
@@ -1099,6 +1142,82 @@ bool double_lookahead(Cnf* c, uint32_t& base, lookahead_order_t lo, size_t bl) {
     }
 }
 
+// Scratch storage for scoring lookahead candidates on a private copy of the
+// truth stamps so that several candidates can be scored at once. The copy is
+// taken right after X3, when every free variable's stamp has been reset, so
+// only real truths are fixed in it and each candidate can be given a fresh
+// private truth level by bumping t.
+struct lookahead_scratch_t {
+    std::vector<uint32_t> val;
+    std::vector<lit_t> stack;
+    uint32_t t;
+
+    bool fixed(lit_t l) const { return val[var(l)] >= t; }
+    bool fixed_true(lit_t l) const {
+        uint32_t v = val[var(l)];
+        if (v < t) return false;
+        return (l > 0) != ((v & 1) == 1);
+    }
+    bool fixed_false(lit_t l) const {
+        uint32_t v = val[var(l)];
+        if (v < t) return false;
+        return (l > 0) != ((v & 1) == 0);
+    }
+    void stamp_true(lit_t l) { val[var(l)] = t + (l < 0 ? 1 : 0); }
+};
+
+// Private-storage version of propagate: stamps the binary consequences of l
+// in the scratch copy instead of the solver state. Returns false if a
+// conflict is found during propagation.
+bool scratch_propagate(Cnf* c, lookahead_scratch_t* s, lit_t l) {
+    size_t h = s->stack.size();
+    if (s->fixed_false(l)) {
+        return false;
+    } else if (!s->fixed_true(l)) {
+        s->stamp_true(l);
+        s->stack.push_back(l);
+    }
+    for (; h < s->stack.size(); ++h) {
+        l = s->stack[h];
+        for (lit_t lp : c->bimp[l]) {
+            if (s->fixed_false(lp)) {
+                return false;
+            } else if (!s->fixed_true(lp)) {
+                s->stamp_true(lp);
+                s->stack.push_back(lp);
+            }
+        }
+    }
+    return true;
+}
+
+// Private-storage version of propagate_lookahead, minus windfalls: computes
+// the sharper heuristic score of l without touching solver state. Returns
+// false exactly when a conflict is found.
+bool scratch_score(Cnf* c, lookahead_scratch_t* s, lit_t l, double* hh) {
+    s->stack.clear();
+    if (!scratch_propagate(c, s, l)) return false;
+    for (size_t g = 0; g < s->stack.size(); ++g) {
+        lit_t lp = s->stack[g];
+        for (const timp_t& t : c->timp[lp]) {
+            if (!t.active) continue;
+            if (s->fixed_true(t.u) || s->fixed_true(t.v)) continue;
+            if (s->fixed_false(t.u) && s->fixed_false(t.v)) { return false; }
+            if (s->fixed_false(t.u)) { // => v not fixed
+                if (!scratch_propagate(c, s, t.v)) return false;
+                continue;
+            }
+            if (s->fixed_false(t.v)) { // => u not fixed
+                if (!scratch_propagate(c, s, t.u)) return false;
+                continue;
+            }
+            // Otherwise, neither u nor v are fixed.
+            *hh += c->h[t.u] * c->h[t.v];
+        }
+    }
+    return true;
+}
+
 // Algorithm X: Lookahead for Algorithm L. Returns false exactly when a conflict
 // is found.
 bool lookahead(Cnf* c) {
@@ -1211,6 +1330,69 @@ bool lookahead(Cnf* c) {
     size_t nf = c->force.size();
     CHECK(!c->lookahead_order.empty()) << "lookahead_order is empty.";
 
+    if (PARAM_lookahead_threads > 1) {
+        // Parallel lookahead: score every candidate in one pass over private
+        // scratch copies of the truth stamps, then merge scores and act on
+        // conflicts and autarkies serially below. Candidates are scored
+        // against a snapshot, so literals forced by one candidate don't
+        // sharpen the scores of later candidates the way they do in the
+        // serial loop, and double lookahead, windfalls, and the wraparound
+        // to a fixed point are all skipped. In exchange, the dominant cost
+        // of a decision -- one propagation per candidate -- runs on all
+        // threads at once.
+        size_t n = c->lookahead_order.size();
+        size_t nthreads =
+            std::min(static_cast<size_t>(PARAM_lookahead_threads), n);
+        std::vector<double> ws(n, 0.0);
+        std::vector<uint8_t> scored(n, 0);
+        std::vector<uint8_t> conflict(n, 0);
+        std::vector<std::thread> threads;
+        for (size_t tid = 0; tid < nthreads; ++tid) {
+            threads.emplace_back([&](size_t start) {
+                lookahead_scratch_t s;
+                s.val = c->val;
+                s.t = 2;
+                for (size_t i = start; i < n; i += nthreads) {
+                    lit_t l = c->lookahead_order[i].lit;
+                    if (s.fixed(l)) continue;  // Fixed at RT in the snapshot.
+                    s.t += 2;
+                    scored[i] = 1;
+                    if (!scratch_score(c, &s, l, &ws[i])) conflict[i] = 1;
+                }
+            }, tid);
+        }
+        for (std::thread& t : threads) { t.join(); }
+
+        // Merge: accumulate H down the candidate forest and replay the
+        // serial loop's conflict (X13) and autarky (X9) reactions.
+        for (size_t i = 0; i < n; ++i) {
+            lit_t l = c->lookahead_order[i].lit;
+            c->dfs[l].H = 0.0;
+            if (c->dfs[l].parent != lit_nil) {
+                c->dfs[l].H = c->dfs[c->dfs[l].parent].H;
+            }
+            // Candidates fixed at RT in the snapshot just inherit their
+            // parent's score.
+            if (!scored[i]) continue;
+            if (conflict[i]) {
+                INC(lookahead_propagation_failures);
+                // X13. [Recover from conflict.]
+                if (!force_lookahead(c, -l)) {
+                    INC(lookahead_conflicts);
+                    return false;
+                }
+                continue;
+            }
+            // Unlike conflicts, autarkies (X9) are not exploited here. A
+            // snapshot autarky only proves equisatisfiability with respect
+            // to the snapshot, and two such deductions can be mutually
+            // inconsistent; the serial loop avoids this by deriving each one
+            // against the live state.
+            if (ws[i] > 0) c->dfs[l].H += ws[i];
+        }
+        return true;
+    }
+
     while (true) {
         // X6. [Choose l for lookahead.]
         lookahead_order_t lo = c->lookahead_order[j];
@@ -1376,6 +1558,7 @@ bool solve(Cnf* c) {
     while (true) {
         lit_t l = lit_nil;
         while (l == lit_nil) {
+            if (cube_done) return false;
             INC(decision_level, c->d);
             // L2. [New node.]
             LOG_EVERY_N_SECS(1, 1) << c->progress_debug_string();
@@ -1386,10 +1569,33 @@ bool solve(Cnf* c) {
                 c->branch[c->d] = NEED_LOOKAHEAD;
                 c->backl[c->d] = c->f;
                 if (c->force.empty()) {
+                    if (cube_cutoff(c)) {
+                        std::vector<lit_t> cube;
+                        for (size_t i = 0; i < c->f; ++i) {
+                            lit_t x = c->rstack[i];
+                            if (var(x) <= c->novars) cube.push_back(x);
+                        }
+                        cube_emit(cube);
+                        INC(cubes_emitted);
+                        // Abandon the branch as if it had been refuted.
+                        // L15. [Backtrack.]
+                        if (c->d == 0) { cube_done = true; return false; }
+                        --c->d;
+                        c->rstack.resize(c->f);
+                        c->f = c->backf[c->d];
+                        l = resolve_conflict(c);
+                        break;
+                    }
                     if (!lookahead(c)) {
                         INC(lookahead_failure);
                         // L15. [Backtrack.]
-                        if (c->d == 0) UNSAT_EXIT;
+                        if (c->d == 0) {
+                            if (cube_emit != nullptr) {
+                                cube_done = true;
+                                return false;
+                            }
+                            UNSAT_EXIT;
+                        }
                         --c->d;
                         c->rstack.resize(c->f);
                         c->f = c->backf[c->d];
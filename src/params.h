@@ -8,9 +8,19 @@
 
 #include "types.h"
 
+// Params are normally mutable globals that can be overridden at startup with
+// -p. When compiled with -DBAKED_PARAMS (make BAKED=1), they become constexpr
+// constants instead: branches on boolean params fold away and values read in
+// hot loops cost nothing, at the price of editing this source to retune.
+// Attempts to override a param with -p in a baked binary fail at startup.
+#ifdef BAKED_PARAMS
+#define DEFINE_PARAM(param, default_val, help_text)   \
+    constexpr double PARAM_##param = default_val;
+#else
 #define DEFINE_PARAM(param, default_val, help_text)   \
     double PARAM_##param = default_val; \
     ParamRegisterer REG_##param(STRING(param), &PARAM_##param, help_text);
+#endif  // BAKED_PARAMS
 
 struct Params {
     void register_param(const char* name, double* val, const char* help_text) {
@@ -19,6 +29,11 @@ struct Params {
     }
 
     void parse(const std::string& param_defs) {
+#ifdef BAKED_PARAMS
+        CHECK(param_defs.empty())
+            << "Params are baked into this binary and can't be overridden: '"
+            << param_defs << "'";
+#endif
         std::istringstream iss(param_defs);
         std::string kv;
         while(std::getline(iss, kv, ';')) {
@@ -1,5 +1,38 @@
+#ifndef __PARSE_H__
+#define __PARSE_H__
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "types.h"
 
+// A pre-parsed binary snapshot of a CNF formula. Snapshots hold the same
+// packed literal array and clause-start index that the solvers build in
+// memory (see Cnf::clauses/Cnf::start in walk.cc), so loading one is just a
+// matter of mapping the file -- no tokenizing required. Snapshots are
+// produced by bin/cnfc and loaded transparently by DIMACS below: any input
+// file starting with the magic bytes "SCNF" is treated as a snapshot.
+//
+// The on-disk layout is the header below, followed by nclauses int64
+// clause-start offsets into the literal array, followed by nlits literals.
+// Literals are stored with the width of lit_t, so a snapshot written by a
+// binary built with (say) LIT_64 can't be read by a LIT_32 build; we record
+// the width in the header and check it at load time.
+constexpr char kSnapshotMagic[4] = {'S','C','N','F'};
+constexpr uint16_t kSnapshotVersion = 1;
+
+struct snapshot_header_t {
+    char magic[4];
+    uint8_t lit_bytes;
+    uint8_t pad;
+    uint16_t version;
+    int64_t nvars;
+    int64_t nclauses;
+    int64_t nlits;
+};
+
 // Parser for a DIMACS cnf input file. File starts with zero or more comments
 // followed by a line declaring the number of variables and clauses in the file.
 // Each subsequent line is the zero-terminated definition of a disjunction.
@@ -18,6 +51,10 @@
 // 3 0
 // -2 -3 4 0
 //
+// The file is mmap-ed once and literals are decoded in place with a hand-
+// rolled integer scanner, so re-reading the file (as Processor does) is just
+// a matter of rewinding a cursor into the mapping.
+//
 // Here's an example of how to use this parser to process a DIMACS input file:
 //
 // DIMACS d(filename);
@@ -31,20 +68,79 @@
 struct DIMACS {
     DIMACS(const char* filename) : filename_(filename) { }
 
-    ~DIMACS() { fclose(f_); }
+    ~DIMACS() {
+        if (map_ != nullptr) munmap(const_cast<char*>(map_), size_);
+    }
 
     void reset() {
-        if (f_ != 0) fclose(f_);
-        f_ = fopen(filename_, "r");
-        CHECK(f_) << "Failed to open file: " << filename_;
+        if (map_ == nullptr) {
+            int fd = open(filename_, O_RDONLY);
+            CHECK(fd >= 0) << "Failed to open file: " << filename_;
+            struct stat sb;
+            CHECK(fstat(fd, &sb) == 0) << "Failed to stat file: " << filename_;
+            size_ = sb.st_size;
+            void* m = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            CHECK(m != MAP_FAILED) << "Failed to mmap file: " << filename_;
+            map_ = static_cast<const char*>(m);
+            close(fd);
+        }
+        pos_ = 0;
+        eof_ = false;
+        curr_ = lit_nil;
 
-        // Read comment lines until we see the problem line.
+        // If the file is a binary snapshot, just set up pointers into the
+        // mapping and return -- there's nothing to tokenize.
+        if (size_ >= sizeof(snapshot_header_t) &&
+            memcmp(map_, kSnapshotMagic, sizeof(kSnapshotMagic)) == 0) {
+            const snapshot_header_t* h =
+                reinterpret_cast<const snapshot_header_t*>(map_);
+            CHECK(h->version == kSnapshotVersion)
+                << "Unsupported snapshot version " << h->version
+                << " in " << filename_;
+            CHECK(h->lit_bytes == sizeof(lit_t))
+                << "Snapshot " << filename_ << " has " << int(h->lit_bytes)
+                << "-byte literals but this binary uses " << sizeof(lit_t)
+                << "-byte literals.";
+            CHECK(h->nvars >= 0) << "Variable count must be non-negative.";
+            CHECK(h->nclauses >= 0) << "Clause count must be non-negative.";
+            CHECK_NO_OVERFLOW(lit_t, h->nvars);
+            CHECK_NO_OVERFLOW(clause_t, h->nclauses);
+            nvars_ = h->nvars;
+            nclauses_ = h->nclauses;
+            snap_nlits_ = h->nlits;
+            snap_start_ = reinterpret_cast<const int64_t*>(
+                map_ + sizeof(snapshot_header_t));
+            snap_lits_ = reinterpret_cast<const lit_t*>(
+                snap_start_ + h->nclauses);
+            snapshot_ = true;
+            snap_clause_ = 0;
+            snap_lit_ = 0;
+            return;
+        }
+
+        // Skip comment lines until we see the problem line.
         long long nv = 0, nc = 0;
-        do {
-            read_ = fscanf(f_, " p cnf %lld %lld \n", &nv, &nc);
-            if (read_ > 0 && read_ != EOF) break;
-            read_ = fscanf(f_, "%*s\n");
-        } while (read_ != 2 && read_ != EOF);
+        bool found_problem_line = false;
+        while (pos_ < size_) {
+            skip_whitespace();
+            if (pos_ >= size_) break;
+            if (map_[pos_] == 'p') {
+                ++pos_;
+                while (pos_ < size_ &&
+                       (map_[pos_] == ' ' || map_[pos_] == '\t')) ++pos_;
+                CHECK(pos_ + 3 <= size_ &&
+                      map_[pos_] == 'c' && map_[pos_+1] == 'n' &&
+                      map_[pos_+2] == 'f')
+                    << "Expected 'cnf' in problem line of " << filename_;
+                pos_ += 3;
+                nv = scan_int();
+                nc = scan_int();
+                found_problem_line = true;
+                break;
+            }
+            skip_line();
+        }
+        if (!found_problem_line) eof_ = true;
         CHECK(nv >= 0) << "Variable count must be non-negative.";
         CHECK(nc >= 0) << "Clause count must be non-negative.";
         CHECK_NO_OVERFLOW(lit_t, nv);
@@ -53,9 +149,20 @@ struct DIMACS {
         nclauses_ = nc;
     }
 
-    inline void advance() { read_ = fscanf(f_, " %i ", &curr_); }
+    inline void advance() {
+        if (snapshot_) {
+            advance_snapshot();
+            return;
+        }
+        skip_whitespace();
+        if (pos_ >= size_) {
+            eof_ = true;
+            return;
+        }
+        curr_ = scan_int();
+    }
 
-    inline bool eof() { return read_ == EOF; }
+    inline bool eof() { return eof_; }
 
     inline bool eoc() { return eof() || curr_ == lit_nil; }
 
@@ -66,10 +173,79 @@ struct DIMACS {
     inline lit_t nclauses() { return nclauses_; }
 
 private:
+    // Produces the same token stream a text file would: the literals of each
+    // clause in order, a lit_nil after each clause, then eof.
+    inline void advance_snapshot() {
+        int64_t nclauses = static_cast<int64_t>(nclauses_);
+        if (snap_clause_ >= nclauses) {
+            eof_ = true;
+            return;
+        }
+        int64_t end = (snap_clause_ + 1 < nclauses) ?
+            snap_start_[snap_clause_ + 1] : snap_nlits_;
+        if (snap_lit_ < end) {
+            curr_ = snap_lits_[snap_lit_++];
+            return;
+        }
+        curr_ = lit_nil;
+        ++snap_clause_;
+    }
+
+    // Advances the cursor past spaces, newlines, and comment lines.
+    inline void skip_whitespace() {
+        while (pos_ < size_) {
+            char ch = map_[pos_];
+            if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r') {
+                ++pos_;
+            } else if (ch == 'c') {
+                skip_line();
+            } else {
+                break;
+            }
+        }
+    }
+
+    // Advances the cursor to the first character after the current line.
+    inline void skip_line() {
+        while (pos_ < size_ && map_[pos_] != '\n') ++pos_;
+        if (pos_ < size_) ++pos_;
+    }
+
+    // Decodes a (possibly negative) decimal integer at the cursor.
+    inline long long scan_int() {
+        while (pos_ < size_ &&
+               (map_[pos_] == ' ' || map_[pos_] == '\t')) ++pos_;
+        bool neg = false;
+        if (pos_ < size_ && map_[pos_] == '-') {
+            neg = true;
+            ++pos_;
+        }
+        CHECK(pos_ < size_ && map_[pos_] >= '0' && map_[pos_] <= '9')
+            << "Expected a digit at byte " << pos_ << " of " << filename_;
+        long long v = 0;
+        while (pos_ < size_ && map_[pos_] >= '0' && map_[pos_] <= '9') {
+            v = v * 10 + (map_[pos_] - '0');
+            ++pos_;
+        }
+        return neg ? -v : v;
+    }
+
     const char* filename_;
-    FILE* f_ = 0;
-    int read_ = 0;
+    const char* map_ = nullptr;
+    size_t size_ = 0;
+    size_t pos_ = 0;
+    bool eof_ = false;
     lit_t curr_ = lit_nil;
     lit_t nvars_;
     clause_t nclauses_;
+
+    // Snapshot state, only used when the input file is a binary snapshot.
+    bool snapshot_ = false;
+    const int64_t* snap_start_ = nullptr;
+    const lit_t* snap_lits_ = nullptr;
+    int64_t snap_nlits_ = 0;
+    int64_t snap_clause_ = 0;
+    int64_t snap_lit_ = 0;
 };
+
+#endif  // __PARSE_H__
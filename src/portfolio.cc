@@ -0,0 +1,113 @@
+// A portfolio solver that runs Algorithm C (cdcl.cc), Algorithm L (look.cc),
+// and Algorithm W (walk.cc) concurrently over a single parsed formula. The
+// input file is parsed exactly once; each engine then builds its own internal
+// clause representation and runs on its own thread. The first engine to finish
+// wins: engines report results by calling exit() (see SAT_EXIT/UNSAT_EXIT in
+// logging.h), which terminates the whole process and with it the losing
+// engines. Since WalkSAT can never prove unsatisfiability, an unsatisfiable
+// instance is decided by whichever of CDCL/lookahead finishes first.
+
+// Standard headers used by the engines must be included here at top level so
+// their include guards keep them from being re-included inside the engine
+// namespaces below.
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "counters.h"
+#include "flags.h"
+#include "heap.h"
+#include "logging.h"
+#include "timer.h"
+#include "types.h"
+#include "params.h"
+#include "process.h"
+
+// Each engine below is compiled into its own namespace so that their Cnf
+// structs, parse/solve functions, and params don't collide. The headers the
+// engines include themselves are no-ops here thanks to include guards, so
+// each namespace picks up just the engine code. main is renamed per engine so
+// the entry points don't collide with ours (we never call them).
+
+// The engines' real main functions rely on falling off the end of main, which
+// is only legal for a function actually named main.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wreturn-type"
+
+#define main cdcl_main
+namespace cdcl {
+#include "cdcl.cc"
+}
+#undef main
+// cdcl.cc defines clause-layout macros that we don't want leaking into the
+// other engines.
+#undef LIT0
+#undef LIT1
+#undef SIZE
+#undef WATCH0
+#undef WATCH1
+#undef PIN
+#undef LBD
+
+#define main look_main
+namespace look {
+#include "look.cc"
+}
+#undef main
+
+#define main walk_main
+namespace walk {
+#include "walk.cc"
+}
+#undef main
+
+#pragma GCC diagnostic pop
+
+// Definitions for flags the engines declare extern inside their namespaces.
+// DRAT logging stays disabled in the portfolio since a winning WalkSAT or
+// lookahead run can't justify a CDCL proof prefix; walk's seed is synced from
+// FLAGS_seed below.
+namespace cdcl { ::std::string FLAGS_dratfile = ""; }
+namespace walk { unsigned long FLAGS_seed = 0; }
+
+int main(int argc, char** argv) {
+    int oidx;
+    CHECK(parse_flags(argc, argv, &oidx)) <<
+        "Usage: " << argv[0] << " <filename>";
+    init_counters();
+    init_timers();
+    walk::FLAGS_seed = FLAGS_seed;
+
+    // Parse once, then let each engine build its own structures from the
+    // shared Processor. The engines read sequentially here since Processor
+    // iteration is stateful; all the heavy lifting afterwards is concurrent.
+    Processor p(argv[oidx]);
+    cdcl::Cnf* cc = cdcl::parse(&p);
+    look::Cnf lc = look::parse(&p);
+    walk::Cnf wc = walk::parse(&p);
+
+    std::thread cdcl_thread([&]{
+        if (cc->clauses.empty() || cdcl::solve(cc)) SAT_EXIT(cc);
+        UNSAT_EXIT;
+    });
+    std::thread look_thread([&]{
+        if (look::solve(&lc)) SAT_EXIT(&lc);
+        UNSAT_EXIT;
+    });
+    std::thread walk_thread([&]{
+        if (wc.clause_storage.empty() || walk::solve(&wc)) SAT_EXIT(&wc);
+    });
+
+    cdcl_thread.join();
+    look_thread.join();
+    walk_thread.join();
+    return UNKNOWN;
+}
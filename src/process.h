@@ -1,3 +1,6 @@
+#ifndef __PROCESS_H__
+#define __PROCESS_H__
+
 #include <algorithm>
 #include <vector>
 
@@ -9,6 +12,11 @@ DEFINE_PARAM(preprocess, 0,
              "If non-zero, pre-process the input formula, applying common "
              "simplifications.");
 
+DEFINE_PARAM(max_elimination_occurrences, 10,
+             "During preprocessing, variable elimination is only attempted "
+             "for variables that occur at most this many times in each "
+             "polarity.");
+
 typedef int32_t cell_size_t;
 constexpr int32_t cell_nil = std::numeric_limits<cell_size_t>::max();
 
@@ -27,7 +35,7 @@ struct Cell {
 
 // When we eliminate a variable, we store a rule that will tell us the truth
 // value of that variable as a function of other un-eliminated variables. Here,
-// clauses is a sequence of lit_nil-delimited clauses. The rule tells us to set
+// clauses is a sequence of lit_nil-separated clauses. The rule tells us to set
 // lit to true iff all clauses are satisfied.
 struct Rule {
     lit_t lit;
@@ -42,6 +50,7 @@ struct Processor {
         nvars_ = dimacs.nvars();
         nclauses_ = dimacs.nclauses();
         val.resize(dimacs.nvars() + 1, false);
+        eliminated_.resize(dimacs.nvars() + 1, false);
         cell_storage.resize(2*nvars_ + 1 + nclauses_);
         cell = &cell_storage[nvars_];
         std::vector<lit_t> c;
@@ -65,19 +74,21 @@ struct Processor {
                 LOG(2) << "Empty clause in input file, unsatisfiable formula.";
                 UNSAT_EXIT;
             }
+            if (dimacs.eof() && c.empty()) break;
 
             // Sort and remove duplicate lits. We want lits sorted by var, with
             // positive lits coming before negative: 1,2,3,-4,5,-5,6,...
-            std::sort(c.begin(), c.end(), [](lit_t x, lit_t y) -> bool {
-                    return abs(x) > abs(y) || (abs(x) == abs(y) && x < y);
-                });
+            std::sort(c.begin(), c.end(), lit_order);
             c.erase(std::unique(c.begin(), c.end()), c.end());
 
-            // TODO: remove tautological clauses
+            // Drop tautological clauses: sorting put v right before -v, so a
+            // tautology shows up as adjacent opposite lits.
+            if (tautological(c)) continue;
 
             // Install the clause.
             cell_size_t ptr = ++clause_end;
             cell_size_t ci = ptr;
+            clauses_.push_back(ci);
             for (const auto& l : c) {
                 cell_size_t nc = alloc_cell();
                 cell[nc].lit = l;
@@ -108,17 +119,55 @@ struct Processor {
         }
 
         // Initialize clause signatures.
-        for (cell_size_t i = lit_end; i < clause_end; ++i) {
-            calc_clause_sig(i);
-            calc_csize(i);
+        for (const cell_size_t ci : clauses_) {
+            calc_clause_sig(ci);
+            calc_csize(ci);
         }
 
         dump_clauses();
+
+        // Run the simplification passes to a fixed point. Each pass shrinks
+        // the formula and can expose new work for the others -- strengthening
+        // creates units, propagation creates elimination candidates, and so
+        // on -- so we just alternate until nothing budges.
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            if (propagate_pass()) changed = true;
+            if (subsume_pass()) changed = true;
+            if (strengthen_pass()) changed = true;
+            if (eliminate_pass()) changed = true;
+            if (probe_pass()) changed = true;
+        }
+
+        // Gather the surviving clauses for the solvers to read.
+        for (const cell_size_t ci : clauses_) {
+            if (live(ci)) active_.push_back(ci);
+        }
+        LOG(1) << "Preprocessing: " << nclauses_ << " clauses reduced to "
+               << active_.size();
+        nclauses_ = active_.size();
+    }
+
+    // Comparator that sorts lits by var, with the positive lit first:
+    // 1,2,3,-4,5,-5,6,...
+    static bool lit_order(lit_t x, lit_t y) {
+        return abs(x) > abs(y) || (abs(x) == abs(y) && x < y);
     }
 
-    void calc_clause_sig(clause_t c) {
+    // True exactly when c, sorted by lit_order and deduped, contains both
+    // polarities of some variable.
+    static bool tautological(const std::vector<lit_t>& c) {
+        for (size_t i = 0; i + 1 < c.size(); ++i) {
+            if (c[i] == -c[i+1]) return true;
+        }
+        return false;
+    }
+
+    void calc_clause_sig(cell_size_t c) {
         cell[c].sig = 0;
-        for(clause_t i = cell[c].clause_next; i != c; i = cell[i].clause_next) {
+        for(cell_size_t i = cell[c].clause_next; i != c;
+            i = cell[i].clause_next) {
             cell[c].sig |= cell[cell[i].lit].sig;
         }
     }
@@ -138,13 +187,374 @@ struct Processor {
         }
     }
 
+    // Is the clause anchored at c still part of the formula?
+    inline bool live(cell_size_t c) { return CSIZE(c) >= 0; }
+
+    // Removes the cell at p from its lit and clause rings and frees it,
+    // adjusting the tally of p's literal. The caller is responsible for the
+    // clause's size and signature.
+    void unlink_cell(cell_size_t p) {
+        cell[cell[p].lit_prev].lit_next = cell[p].lit_next;
+        cell[cell[p].lit_next].lit_prev = cell[p].lit_prev;
+        cell[cell[p].clause_prev].clause_next = cell[p].clause_next;
+        cell[cell[p].clause_next].clause_prev = cell[p].clause_prev;
+        --TALLY(cell[p].lit);
+        free_cell(p);
+    }
+
+    // Removes the clause anchored at ci from the formula, freeing its cells.
+    void remove_clause(cell_size_t ci) {
+        cell_size_t p = cell[ci].clause_next;
+        while (p != ci) {
+            cell_size_t next = cell[p].clause_next;
+            unlink_cell(p);
+            p = next;
+        }
+        CSIZE(ci) = -1;  // dead
+    }
+
+    // Installs a new clause with the given literals and returns its anchor.
+    cell_size_t add_clause(const std::vector<lit_t>& c) {
+        cell_size_t ci = alloc_cell();
+        cell[ci].clause_next = cell[ci].clause_prev = ci;
+        cell[ci].lit_next = cell[ci].lit_prev = ci;
+        cell[ci].sig = 0;
+        CSIZE(ci) = 0;
+        cell_size_t ptr = ci;
+        for (const auto& l : c) {
+            cell_size_t nc = alloc_cell();
+            cell[nc].lit = l;
+            cell[nc].clause = ci;
+
+            cell[nc].clause_prev = ptr;
+            cell[nc].clause_next = cell[ptr].clause_next;
+            cell[cell[ptr].clause_next].clause_prev = nc;
+            cell[ptr].clause_next = nc;
+
+            cell[nc].lit_prev = l;
+            cell[nc].lit_next = cell[l].lit_next;
+            cell[cell[l].lit_next].lit_prev = nc;
+            cell[l].lit_next = nc;
+
+            ++TALLY(l);
+            ++CSIZE(ci);
+            cell[ci].sig |= cell[l].sig;
+            ptr = nc;
+        }
+        clauses_.push_back(ci);
+        return ci;
+    }
+
+    // Permanently assigns l true: records an erp rule fixing l, removes
+    // every clause satisfied by l and deletes -l from the rest, exiting if
+    // that empties a clause. The variable is marked eliminated so later
+    // passes skip it; its occurrence lists are empty from here on.
+    void assign_lit(lit_t l) {
+        LOG(3) << "Fixing literal " << l << " at root level";
+        rules.push_back(Rule());
+        rules.back().lit = l;  // No clauses: unconditionally true.
+        std::vector<cell_size_t> occ;
+        for (cell_size_t p = cell[l].lit_next; p != l; p = cell[p].lit_next) {
+            occ.push_back(cell[p].clause);
+        }
+        for (const cell_size_t ci : occ) remove_clause(ci);
+        occ.clear();
+        for (cell_size_t p = cell[-l].lit_next; p != -l;
+             p = cell[p].lit_next) {
+            occ.push_back(p);
+        }
+        for (const cell_size_t p : occ) {
+            cell_size_t di = cell[p].clause;
+            unlink_cell(p);
+            --CSIZE(di);
+            calc_clause_sig(di);
+            if (CSIZE(di) == 0) {
+                LOG(2) << "Unit propagation derived an empty clause, "
+                       << "unsatisfiable formula.";
+                UNSAT_EXIT;
+            }
+        }
+        eliminated_[abs(l)] = true;
+        INC(literals_fixed);
+    }
+
+    // Runs unit propagation to fixpoint: any live unit clause forces its
+    // literal, which can shrink other clauses down to new units.
+    bool propagate_pass() {
+        bool changed = false;
+        bool found = true;
+        while (found) {
+            found = false;
+            for (const cell_size_t ci : clauses_) {
+                if (!live(ci) || CSIZE(ci) != 1) continue;
+                assign_lit(cell[cell[ci].clause_next].lit);
+                found = changed = true;
+            }
+        }
+        return changed;
+    }
+
+    // True exactly when every literal of c except skip also appears in d.
+    bool subset_except(cell_size_t c, cell_size_t d, lit_t skip) {
+        for (cell_size_t p = cell[c].clause_next; p != c;
+             p = cell[p].clause_next) {
+            lit_t l = cell[p].lit;
+            if (l == skip) continue;
+            bool found = false;
+            for (cell_size_t q = cell[d].clause_next; q != d;
+                 q = cell[q].clause_next) {
+                if (cell[q].lit == l) { found = true; break; }
+            }
+            if (!found) return false;
+        }
+        return true;
+    }
+
+    // Removes every clause that's subsumed by (contains a superset of the
+    // literals of) some other clause. Any clause containing all of c's
+    // literals shows up on the occurrence list of each of c's literals, so we
+    // only need to scan the shortest such list; clause signatures prune most
+    // candidates before the exact subset test.
+    bool subsume_pass() {
+        bool changed = false;
+        std::vector<cell_size_t> cand;
+        for (const cell_size_t ci : clauses_) {
+            if (!live(ci)) continue;
+            lit_t best = lit_nil;
+            for (cell_size_t p = cell[ci].clause_next; p != ci;
+                 p = cell[p].clause_next) {
+                lit_t l = cell[p].lit;
+                if (best == lit_nil || TALLY(l) < TALLY(best)) best = l;
+            }
+            if (best == lit_nil) continue;
+            cand.clear();
+            for (cell_size_t p = cell[best].lit_next; p != best;
+                 p = cell[p].lit_next) {
+                cand.push_back(cell[p].clause);
+            }
+            for (const cell_size_t di : cand) {
+                if (di == ci || !live(di)) continue;
+                if (CSIZE(di) < CSIZE(ci)) continue;
+                if ((cell[ci].sig & ~cell[di].sig) != 0) continue;
+                if (!subset_except(ci, di, lit_nil)) continue;
+                LOG(3) << "Clause " << di << " subsumed by " << ci;
+                remove_clause(di);
+                INC(clauses_subsumed);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    // Self-subsumption: if clause c contains l and clause d contains -l along
+    // with all of c's other literals, resolving c and d on l yields a clause
+    // identical to d minus -l, so -l can simply be deleted from d.
+    bool strengthen_pass() {
+        bool changed = false;
+        std::vector<cell_size_t> cand;
+        for (const cell_size_t ci : clauses_) {
+            if (!live(ci)) continue;
+            for (cell_size_t p = cell[ci].clause_next; p != ci;
+                 p = cell[p].clause_next) {
+                lit_t l = cell[p].lit;
+                cand.clear();
+                for (cell_size_t q = cell[-l].lit_next; q != -l;
+                     q = cell[q].lit_next) {
+                    cand.push_back(q);
+                }
+                for (const cell_size_t q : cand) {
+                    cell_size_t di = cell[q].clause;
+                    if (di == ci || !live(di)) continue;
+                    if (CSIZE(di) < CSIZE(ci)) continue;
+                    if ((cell[ci].sig & ~(cell[di].sig | cell[l].sig)) != 0) {
+                        continue;
+                    }
+                    if (!subset_except(ci, di, l)) continue;
+                    LOG(3) << "Removing " << -l << " from clause " << di
+                           << ", self-subsumed by " << ci;
+                    unlink_cell(q);
+                    --CSIZE(di);
+                    calc_clause_sig(di);
+                    INC(clauses_strengthened);
+                    changed = true;
+                    if (CSIZE(di) == 0) {
+                        LOG(2) << "Clause strengthened to empty clause, "
+                               << "unsatisfiable formula.";
+                        UNSAT_EXIT;
+                    }
+                }
+            }
+        }
+        return changed;
+    }
+
+    // Computes the resolvent of clauses c (containing v) and d (containing
+    // -v) on variable v, leaving the result in resolvent_. Returns false iff
+    // the resolvent is a tautology.
     bool resolve(cell_size_t c, cell_size_t d, lit_t v) {
-        return true; // TODO
+        resolvent_.clear();
+        for (cell_size_t p = cell[c].clause_next; p != c;
+             p = cell[p].clause_next) {
+            if (cell[p].lit != v) resolvent_.push_back(cell[p].lit);
+        }
+        for (cell_size_t p = cell[d].clause_next; p != d;
+             p = cell[p].clause_next) {
+            if (cell[p].lit != -v) resolvent_.push_back(cell[p].lit);
+        }
+        std::sort(resolvent_.begin(), resolvent_.end(), lit_order);
+        resolvent_.erase(std::unique(resolvent_.begin(), resolvent_.end()),
+                         resolvent_.end());
+        return !tautological(resolvent_);
+    }
+
+    // Bounded variable elimination (NiVER): a variable v can be replaced by
+    // the set of all resolvents on v as long as those resolvents don't
+    // contain more literals in total than the clauses they replace. An erp
+    // rule is recorded for each eliminated variable so its value can be
+    // reconstructed from a satisfying assignment of the reduced formula.
+    bool eliminate_pass() {
+        bool changed = false;
+        std::vector<cell_size_t> pos, neg;
+        std::vector<std::vector<lit_t>> resolvents;
+        for (lit_t v = 1; v <= nvars_; ++v) {
+            if (eliminated_[v]) continue;
+            if (TALLY(v) == 0 && TALLY(-v) == 0) continue;
+            if (TALLY(v) > PARAM_max_elimination_occurrences ||
+                TALLY(-v) > PARAM_max_elimination_occurrences) continue;
+            pos.clear();
+            neg.clear();
+            for (cell_size_t p = cell[v].lit_next; p != v;
+                 p = cell[p].lit_next) {
+                pos.push_back(cell[p].clause);
+            }
+            for (cell_size_t p = cell[-v].lit_next; p != -v;
+                 p = cell[p].lit_next) {
+                neg.push_back(cell[p].clause);
+            }
+            size_t before = 0;
+            for (const cell_size_t c : pos) before += CSIZE(c);
+            for (const cell_size_t c : neg) before += CSIZE(c);
+
+            resolvents.clear();
+            size_t after = 0;
+            bool ok = true;
+            for (const cell_size_t c : pos) {
+                for (const cell_size_t d : neg) {
+                    if (!resolve(c, d, v)) continue;  // Tautology, discard.
+                    if (resolvent_.empty()) {
+                        LOG(2) << "Resolved empty clause on variable " << v
+                               << ", unsatisfiable formula.";
+                        UNSAT_EXIT;
+                    }
+                    after += resolvent_.size();
+                    if (after > before) { ok = false; break; }
+                    resolvents.push_back(resolvent_);
+                }
+                if (!ok) break;
+            }
+            if (!ok) continue;
+
+            // Record the erp rule before touching the clauses: v must be set
+            // true exactly when some clause that contained v isn't satisfied
+            // by the rest of the assignment, i.e. -v is true iff all of v's
+            // clauses (minus v itself) are satisfied.
+            rules.push_back(Rule());
+            Rule& r = rules.back();
+            r.lit = -v;
+            bool empty_clause = false;
+            bool first = true;
+            for (const cell_size_t c : pos) {
+                if (CSIZE(c) == 1) { empty_clause = true; break; }
+                if (!first) r.clauses.push_back(lit_nil);
+                first = false;
+                for (cell_size_t p = cell[c].clause_next; p != c;
+                     p = cell[p].clause_next) {
+                    if (cell[p].lit != v) r.clauses.push_back(cell[p].lit);
+                }
+            }
+            if (empty_clause) {
+                // Some clause was the unit (v), so v is just forced true. A
+                // lone lit_nil reads as a single unsatisfiable empty clause.
+                r.clauses.assign(1, lit_nil);
+            }
+
+            LOG(3) << "Eliminating variable " << v << " (" << pos.size()
+                   << " x " << neg.size() << " -> " << resolvents.size()
+                   << " resolvents)";
+            for (const cell_size_t c : pos) remove_clause(c);
+            for (const cell_size_t c : neg) remove_clause(c);
+            for (const auto& rc : resolvents) add_clause(rc);
+            eliminated_[v] = true;
+            INC(variables_eliminated);
+            changed = true;
+        }
+        return changed;
+    }
+
+    // True exactly when assuming l leads to a conflict by unit propagation.
+    // The propagation is simulated with a scratch assignment in pval_; the
+    // clause graph isn't touched. Assigning a literal u can only shrink
+    // clauses containing -u, so those are the only ones we rescan.
+    bool probe_failed(lit_t l) {
+        pval_.assign(nvars_ + 1, 0);
+        probe_queue_.clear();
+        pval_[abs(l)] = l > 0 ? 1 : -1;
+        probe_queue_.push_back(l);
+        for (size_t qi = 0; qi < probe_queue_.size(); ++qi) {
+            lit_t u = probe_queue_[qi];
+            for (cell_size_t p = cell[-u].lit_next; p != -u;
+                 p = cell[p].lit_next) {
+                cell_size_t di = cell[p].clause;
+                lit_t unit = lit_nil;
+                bool sat = false;
+                int free = 0;
+                for (cell_size_t q = cell[di].clause_next; q != di;
+                     q = cell[q].clause_next) {
+                    lit_t x = cell[q].lit;
+                    int v = pval_[abs(x)];
+                    if (v == 0) { ++free; unit = x; }
+                    else if ((v > 0) == (x > 0)) { sat = true; break; }
+                }
+                if (sat) continue;
+                if (free == 0) return true;
+                if (free == 1) {
+                    pval_[abs(unit)] = unit > 0 ? 1 : -1;
+                    probe_queue_.push_back(unit);
+                }
+            }
+        }
+        return false;
+    }
+
+    // Failed-literal probing: if assuming l yields a conflict by unit
+    // propagation alone, then -l is forced and the formula can be simplified
+    // permanently. Probing l can only start a propagation chain if some
+    // binary clause contains -l, so other literals are skipped.
+    bool probe_pass() {
+        bool changed = false;
+        for (lit_t v = 1; v <= nvars_; ++v) {
+            for (const lit_t l : {v, lit_t(-v)}) {
+                if (eliminated_[v]) break;
+                bool binary = false;
+                for (cell_size_t p = cell[-l].lit_next; p != -l;
+                     p = cell[p].lit_next) {
+                    if (CSIZE(cell[p].clause) == 2) { binary = true; break; }
+                }
+                if (!binary) continue;
+                if (!probe_failed(l)) continue;
+                LOG(3) << "Failed literal " << l << ", forcing " << -l;
+                INC(failed_literals);
+                assign_lit(-l);
+                propagate_pass();
+                changed = true;
+            }
+        }
+        return changed;
     }
 
     void dump_clauses() {
         for (size_t i = lit_end; i < cell_storage.size(); ++i) {
-            LOG(0) << "[" << i - nvars_ << "]: (" << cell_storage[i].lit << ") "
+            LOG(3) << "[" << i - nvars_ << "]: (" << cell_storage[i].lit << ") "
                    << " ( " << cell_storage[i].clause << ") "
                    << "<" << cell_storage[i].clause_prev << ","
                    << cell_storage[i].clause_next << "> {"
@@ -158,8 +568,10 @@ struct Processor {
             dimacs.reset();
             return;
         }
-        cptr = lit_end;
-        eof_ = cptr >= clause_end;
+        ai_ = 0;
+        in_clause_ = false;
+        eof_ = active_.empty();
+        if (!eof_) cptr = active_[0];
     }
 
     bool eof() {
@@ -172,16 +584,24 @@ struct Processor {
             dimacs.advance();
             return;
         }
+        if (eof_) return;
+        in_clause_ = true;
         cptr = cell[cptr].clause_next;
-        if (cptr < clause_end) {
-            ++cptr;
-            if (cptr >= clause_end) { eof_ = true; }
+        if (cptr == active_[ai_]) {
+            // Wrapped around to the anchor: end of the current clause.
+            in_clause_ = false;
+            ++ai_;
+            if (ai_ >= active_.size()) {
+                eof_ = true;
+            } else {
+                cptr = active_[ai_];
+            }
         }
     }
 
     bool eoc() {
         if (!PARAM_preprocess) return dimacs.eoc();
-        return eof() || cptr < clause_end;
+        return eof() || !in_clause_;
     }
 
     lit_t curr() {
@@ -231,7 +651,10 @@ struct Processor {
             bool sat = r.clauses.empty();
             for (lit_t l : r.clauses) {
                 if (l == lit_nil && !sat ) break;  // nothing sat in current
-                if (l == lit_nil /* && sat */) sat = false;  // reset for next
+                if (l == lit_nil /* && sat */) {
+                    sat = false;  // reset for next clause
+                    continue;     // never test the separator as a literal
+                }
                 if (val[abs(l)] == (l > 0)) sat = true;  // sat in current
             }
             val[abs(r.lit)] = (sat == (r.lit > 0));
@@ -262,4 +685,18 @@ struct Processor {
     lit_t nvars_;
     clause_t nclauses_;
     bool eof_;
+
+    // All clause anchors ever installed (some may be dead) and, after
+    // preprocessing finishes, the anchors of the surviving clauses in the
+    // order solvers will read them.
+    std::vector<cell_size_t> clauses_;
+    std::vector<cell_size_t> active_;
+    std::vector<bool> eliminated_;
+    std::vector<lit_t> resolvent_;
+    std::vector<int> pval_;          // Scratch assignment for probing.
+    std::vector<lit_t> probe_queue_;
+    size_t ai_;        // Index into active_ of the clause being read.
+    bool in_clause_;   // Is cptr in the middle of a clause?
 };
+
+#endif  // __PROCESS_H__
@@ -0,0 +1,80 @@
+#include <cstdio>
+
+#include "counters.h"
+#include "flags.h"
+#include "logging.h"
+#include "process.h"
+
+#define EXPECT_EQ(x,y) if ((x) != (y)) { LOG(0) << #x << " != " << #y; }
+#define TEST(x,y) static void test_##x() \
+    { LOG(1) << "--------- Running " << __func__ << " ---------" ; y \
+      LOG(3) << "--------- Finished " << __func__ << " ---------"; }
+#define RUN(x) test_##x()
+
+// Writes contents to a scratch DIMACS file and returns its path.
+static const char* write_cnf(const char* contents) {
+    static const char* path = "/tmp/process_test.cnf";
+    FILE* f = fopen(path, "w");
+    CHECK(f != nullptr) << "Couldn't open " << path;
+    fputs(contents, f);
+    fclose(f);
+    return path;
+}
+
+// An erp rule sets its literal true iff every lit_nil-separated clause in the
+// rule is satisfied. The separator must never be evaluated as a literal:
+// doing so reads val[0] == (0 > 0) and spuriously re-satisfies the clause
+// that follows, collapsing the conjunction to "first clause satisfied".
+TEST(erp_rule_conjunction,
+     PARAM_preprocess = 0;
+     Processor p(write_cnf("p cnf 3 1\n1 2 3 0\n"));
+     p.val.assign(4, false);
+     Rule r;
+     r.lit = -1;
+     r.clauses.push_back(2);
+     r.clauses.push_back(lit_nil);
+     r.clauses.push_back(3);
+
+     // First clause satisfied, second not: -1 must come out false.
+     p.val[2] = true;
+     p.val[3] = false;
+     p.rules.push_back(r);
+     p.apply_rules();
+     EXPECT_EQ(p.val[1], true);
+
+     // Both clauses satisfied: -1 must come out true.
+     p.val[3] = true;
+     p.rules.push_back(r);
+     p.apply_rules();
+     EXPECT_EQ(p.val[1], false);
+
+     // First clause unsatisfied: -1 must come out false.
+     p.val[2] = false;
+     p.rules.push_back(r);
+     p.apply_rules();
+     EXPECT_EQ(p.val[1], true);
+    )
+
+// End-to-end: eliminating a variable with two positive occurrences records a
+// multi-clause erp rule, and applying the rules extends the (empty, here)
+// simplified formula's assignment to a model of the original clauses.
+TEST(eliminate_multiple_positive,
+     PARAM_preprocess = 1;
+     Processor p(write_cnf("p cnf 4 3\n1 2 0\n1 3 0\n-1 4 0\n"));
+     p.reset();
+     EXPECT_EQ(p.eliminated_[1], true);
+     p.apply_rules();
+     EXPECT_EQ(p.val[1] || p.val[2], true);   // (1 2)
+     EXPECT_EQ(p.val[1] || p.val[3], true);   // (1 3)
+     EXPECT_EQ(!p.val[1] || p.val[4], true);  // (-1 4)
+    )
+
+int main(int argc, char **argv) {
+    int oidx;
+    CHECK(parse_flags(argc, argv, &oidx)) <<
+        "Usage: " << argv[0] << " <filename>";
+
+    LOG(0) << "Running all tests. No output below means everything passes.";
+    RUN(erp_rule_conjunction);
+    RUN(eliminate_multiple_positive);
+}
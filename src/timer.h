@@ -4,6 +4,7 @@
 #include "math.h"
 #include "signal.h"
 
+#include <algorithm>
 #include <ctime>
 #include <iomanip>
 #include <map>
@@ -99,12 +100,135 @@ private:
     const char* name_;
 };
 
+// Phase timers: scoped timers cheap enough for hot loops. Timer above costs
+// a clock() call plus a map lookup per start/stop, which is fine for
+// whole-run phases like "parse" and "solve" but far too slow to wrap each
+// propagation or conflict analysis. Phase timers instead read
+// CLOCK_MONOTONIC_RAW and index into preregistered slots, so a start/stop
+// pair is two clock reads and a few array writes. Each phase also keeps a
+// power-of-two histogram of its durations, reported at exit:
+//
+//   DEFINE_PHASE(propagation);     // At file scope; creates PHASE_propagation.
+//   { Phase t(PHASE_propagation); ... }
+//
+// Like Timer, phases only record when -t is passed; when it isn't, a Phase
+// costs a single branch.
+class PhaseTimers {
+public:
+    static constexpr int kMaxPhases = 16;
+    // Durations are bucketed by bit length of nanoseconds; 2^40ns > 18min,
+    // longer durations land in the top bucket.
+    static constexpr int kBuckets = 40;
+
+    int register_phase(const char* name) {
+        CHECK(nphases_ < kMaxPhases) << "Too many phase timers.";
+        names_[nphases_] = name;
+        return nphases_++;
+    }
+
+    inline void record(int slot, uint64_t ns) {
+        sum_ns_[slot] += ns;
+        ++count_[slot];
+        int b = 64 - __builtin_clzll(ns | 1);
+        ++hist_[slot][b < kBuckets ? b : kBuckets - 1];
+    }
+
+    void print() {
+        for (int i = 0; i < nphases_; ++i) {
+            if (count_[i] == 0) continue;
+            PRINT << "c phase: [" << names_[i] << "] = "
+                  << ns_string(sum_ns_[i]) << " over " << count_[i]
+                  << " calls (avg: " << ns_string(sum_ns_[i] / count_[i])
+                  << ")" << std::endl;
+            uint64_t max_bucket = 0;
+            for (int b = 0; b < kBuckets; ++b) {
+                max_bucket = std::max(max_bucket, hist_[i][b]);
+            }
+            for (int b = 0; b < kBuckets; ++b) {
+                if (hist_[i][b] == 0) continue;
+                PRINT << "c phase:   [" << std::setw(5)
+                      << ns_string(b == 0 ? 0 : 1ull << (b-1)) << ", "
+                      << std::setw(5) << ns_string(1ull << b) << "): "
+                      << std::setw(10) << hist_[i][b] << " ";
+                for (uint64_t j = 0; j < 40 * hist_[i][b] / max_bucket; ++j) {
+                    PRINT << "#";
+                }
+                PRINT << std::endl;
+            }
+        }
+    }
+
+    void dump() {
+        print();
+        for (int i = 0; i < nphases_; ++i) {
+            sum_ns_[i] = count_[i] = 0;
+            for (int b = 0; b < kBuckets; ++b) hist_[i][b] = 0;
+        }
+    }
+
+    static std::string ns_string(uint64_t ns) {
+        std::ostringstream oss;
+        if (ns < 1000) {
+            oss << ns << "ns";
+        } else if (ns < 1000000) {
+            oss << ns / 1000 << "µs";
+        } else if (ns < 1000000000) {
+            oss << ns / 1000000 << "ms";
+        } else {
+            oss << std::fixed << std::setprecision(1) << ns / 1e9 << "s";
+        }
+        return oss.str();
+    }
+private:
+    // All members are zero-initialized at load time, so registrations from
+    // static initializers in any order are safe.
+    const char* names_[kMaxPhases];
+    uint64_t sum_ns_[kMaxPhases];
+    uint64_t count_[kMaxPhases];
+    uint64_t hist_[kMaxPhases][kBuckets];
+    int nphases_;
+};
+
+static PhaseTimers _phase_timers;
+
+#define DEFINE_PHASE(phase) \
+    static const int PHASE_##phase = _phase_timers.register_phase(STRING(phase));
+
+class Phase {
+public:
+    explicit Phase(int slot) : slot_(-1) {
+        if (!TIMERS) return;
+        if (!FLAGS_time) return;
+        slot_ = slot;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &start_);
+    }
+
+    // Stops the timer early, before the end of the enclosing scope. Useful
+    // for timing the head of a block that doesn't have its own braces.
+    void stop() {
+        if (slot_ < 0) return;
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+        _phase_timers.record(slot_,
+                             (end.tv_sec - start_.tv_sec) * 1000000000ull +
+                             (end.tv_nsec - start_.tv_nsec));
+        slot_ = -1;
+    }
+
+    ~Phase() { stop(); }
+private:
+    int slot_;
+    struct timespec start_;
+};
+
 void init_timers() {
     if (!TIMERS) return;
     if (!FLAGS_time) return;
-    std::atexit([]{ _timers.dump(); });
+    std::atexit([]{ _timers.dump(); _phase_timers.dump(); });
     struct sigaction sigbreak;
-    sigbreak.sa_handler = [](int signum) { _timers.dump(); exit(UNKNOWN); };
+    sigbreak.sa_handler = [](int signum) {
+        _timers.dump(); _phase_timers.dump(); exit(UNKNOWN);
+    };
     sigemptyset(&sigbreak.sa_mask);
     sigbreak.sa_flags = 0;
     CHECK(sigaction(SIGINT, &sigbreak, NULL) == 0);
@@ -6,12 +6,18 @@
 #include <cstdint>
 #include <limits>
 
-// TODO: do this lit/clause size ifdef below better
-// TODO: CLAUSE_64 doesn't work yet...
-// TODO: cdcl requires same bit width between LIT/CLAUSE...
+// Literal and clause index widths are compile parameters: pass -DLIT_16,
+// -DCLAUSE_64, etc. to override the 32-bit defaults below. The Makefile
+// builds small/medium/large cdcl variants this way, and script/solve.sh
+// picks one based on the instance's DIMACS header.
 
+#if !defined(LIT_8) && !defined(LIT_16) && !defined(LIT_32) && !defined(LIT_64)
 #define LIT_32 1
+#endif
+#if !defined(CLAUSE_8) && !defined(CLAUSE_16) && !defined(CLAUSE_32) && \
+    !defined(CLAUSE_64)
 #define CLAUSE_32 1
+#endif
 
 #ifdef LIT_8
 typedef int8_t lit_t;
@@ -2,7 +2,10 @@
 
 // This program either finds a satisfying assignment or runs forever.
 
+#include <algorithm>
+#include <cmath>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #include "counters.h"
@@ -35,9 +38,47 @@ DEFINE_PARAM(move_to_front, 1,
              "to the front of clauses in hopes that they'll be quicker to find "
              "when we need to turn them off.");
 
+DEFINE_PARAM(prob_sat, 0,
+             "If non-zero, choose flip literals by sampling a distribution "
+             "over break counts, probSAT-style, instead of the min-cost scan "
+             "in W4, and use cached critical literals instead of rescanning "
+             "clause bodies in W5.");
+
+DEFINE_PARAM(prob_sat_cb, 2.5,
+             "Base of the exponential break count weighting used when "
+             "prob_sat is non-zero: a literal with break count b is chosen "
+             "with probability proportional to prob_sat_cb^-b.");
+
+DEFINE_PARAM(warm_restart_frac, 0.25,
+             "If non-zero, epochs after the first warm-start from the "
+             "previous assignment by flipping this fraction of the variables "
+             "instead of reinitializing every variable and clause from "
+             "scratch. 0 restarts every epoch with a fresh random "
+             "assignment.");
+
+DEFINE_PARAM(warm_restart_unsat_bias, 0.5,
+             "Probability that each warm-restart flip picks its variable "
+             "from a currently unsatisfied clause rather than uniformly at "
+             "random.");
+
+DEFINE_PARAM(walk_threads, 1,
+             "If > 1, run this many independent walkers on separate threads "
+             "with different seeds, sharing one read-only copy of the "
+             "formula. The first walker to find a satisfying assignment "
+             "reports it and exits.");
+
+// Break counts at or above this value all get the smallest weight in the
+// probSAT weight table.
+constexpr clause_t kMaxWeightedBreak = 63;
+
+// Per-thread RNG state, so that concurrent walkers neither contend on nor
+// share the global rand() stream. Seeded from FLAGS_seed, plus the walker
+// index in multi-walker mode.
+static thread_local unsigned int rng_state = 1;
+
 // Flips a coin that lands on heads with probability p. Return true iff heads.
 static bool flip(float p) {
-    return static_cast<float>(rand())/RAND_MAX <= p;
+    return static_cast<float>(rand_r(&rng_state))/RAND_MAX <= p;
 }
 
 struct Cnf {
@@ -56,14 +97,22 @@ struct Cnf {
     // be stored as [1][2][3][-2][-1]. The start array (below) keeps track of
     // where each clause starts -- in the example above, start[0] = 0 and
     // start[1] = 2. The end index of each clause can be inferred from the start
-    // index of the next clause.
-    std::vector<lit_t> clauses;
+    // index of the next clause. The storage lives in the Cnf built by parse;
+    // walker views created by the view constructor share it through the
+    // clauses pointer.
+    std::vector<lit_t> clause_storage;
+    lit_t* clauses;
 
     // Zero-indexed map of clauses. Literals in clause i run from
     // clauses[start[i]] to clauses[start[i+1]] - 1 except for the final
-    // clause, where the endpoint is just clauses.size() - 1. start.size() is
-    // the number of clauses. "Clause indexes" refer to entries in this array.
-    std::vector<clause_t> start;
+    // clause, where the endpoint is just nlits - 1. As with clauses, walker
+    // views share the parsed instance's storage. "Clause indexes" refer to
+    // entries in this array.
+    std::vector<clause_t> start_storage;
+    clause_t* start;
+
+    // Total number of literals in clauses, i.e. the end of the final clause.
+    clause_t nlits;
 
     // One-indexed values of variables in the satisfying assignment.
     std::vector<bool> val;
@@ -72,9 +121,17 @@ struct Cnf {
     // that variable's value is flipped.
     std::vector<clause_t> cost;
 
-    // Maps literals to a list of clauses (by index) the literal is in.
-    std::vector<std::vector<clause_t>> invclause_storage;
-    std::vector<clause_t>* invclause;
+    // Maps literals to the clauses (by index) each literal is in, stored in
+    // compressed sparse row form: invclause is one flat array of clause
+    // indexes, grouped by literal, and invclause_offset[l] is the index in
+    // invclause where literal l's group begins. The flip loop in W5 walks
+    // these groups on every flip, so keeping them contiguous matters. As
+    // with clauses, the storage lives in the parsed Cnf and walker views
+    // share it.
+    std::vector<clause_t> invclause_storage;
+    clause_t* invclause;
+    std::vector<clause_t> invclause_offset_storage;
+    clause_t* invclause_offset;
 
     // Stack of unsatisfied clause indexes.
     std::vector<lit_t> unsat;
@@ -87,25 +144,61 @@ struct Cnf {
     // Maps clause indexes to number of true literals in clause
     std::vector<lit_t> numtrue;
 
+    // Maps clause indexes to the sum of their currently true literals. When
+    // numtrue[i] == 1, tsum[i] is exactly the clause's critical literal, so
+    // the bookkeeping in W5 can locate it without rescanning the clause.
+    std::vector<int64_t> tsum;
+
     Cnf(Processor* p) :
         p(p),
         nvars(p->nvars()),
         nclauses(p->nclauses()),
+        clauses(nullptr),
+        start(nullptr),
+        nlits(0),
         val(nvars+1),
         cost(nvars+1, 0),
-        invclause_storage(2 * nvars + 1),
-        invclause(&invclause_storage[nvars]),
+        invclause(nullptr),
+        invclause_offset(nullptr),
         unsat_index(nclauses, clause_nil),
-        numtrue(nclauses, 0) {
+        numtrue(nclauses, 0),
+        tsum(nclauses, 0) {
         if (FLAGS_seed == 0) FLAGS_seed = time(NULL);
-        srand(FLAGS_seed);
+        rng_state = FLAGS_seed;
     }
 
+    // Walker view of base: shares base's read-only formula arrays but gets
+    // private copies of all mutable search state, so several walkers can run
+    // concurrently over one copy of the formula.
+    explicit Cnf(const Cnf* base) :
+        p(base->p),
+        nvars(base->nvars),
+        nclauses(base->nclauses),
+        clauses(base->clauses),
+        start(base->start),
+        nlits(base->nlits),
+        val(nvars+1),
+        cost(nvars+1, 0),
+        invclause(base->invclause),
+        invclause_offset(base->invclause_offset),
+        unsat_index(nclauses, clause_nil),
+        numtrue(nclauses, 0),
+        tsum(nclauses, 0) {}
+
     // These two methods give the begin/end index of the kth clause in the
     // clauses vector. Used for iterating over all literals in the kth clause.
     inline clause_t clause_begin(clause_t c) const { return start[c]; }
     inline clause_t clause_end(clause_t c) const {
-        return (c == nclauses - 1) ? clauses.size() : start[c + 1];
+        return (c == nclauses - 1) ? nlits : start[c + 1];
+    }
+
+    // These two methods give the begin/end index into invclause of the group
+    // of clauses containing literal l.
+    inline clause_t invclause_begin(lit_t l) const {
+        return invclause_offset[l];
+    }
+    inline clause_t invclause_end(lit_t l) const {
+        return invclause_offset[l + 1];
     }
 
     inline bool is_true(lit_t l) {
@@ -142,7 +235,7 @@ struct Cnf {
 
     std::string dump_clauses() {
         std::ostringstream oss;
-        for (size_t i = 0; i < start.size(); ++i) {
+        for (clause_t i = 0; i < nclauses; ++i) {
             oss << dump_clause(i);
         }
         return oss.str();
@@ -170,58 +263,206 @@ Cnf parse(Processor* p) {
     p->reset();
     Cnf c(p);
     while (!p->eof()) {
-        std::size_t start = c.clauses.size();
+        std::size_t start = c.clause_storage.size();
         for (p->advance(); !p->eoc(); p->advance()) {
-            c.clauses.push_back(p->curr());
+            c.clause_storage.push_back(p->curr());
         }
-        if (p->eof() && start == c.clauses.size()) break;
-        if (!p->eof() && start == c.clauses.size()) {
+        if (p->eof() && start == c.clause_storage.size()) break;
+        if (!p->eof() && start == c.clause_storage.size()) {
             LOG(2) << "Empty clause in input file, unsatisfiable formula.";
             UNSAT_EXIT;
         }
-        c.start.push_back(start);
+        c.start_storage.push_back(start);
     }
-    CHECK(c.start.size() == c.nclauses) << "Expected nclauses == start.size()";
-
+    CHECK(c.start_storage.size() == c.nclauses)
+        << "Expected nclauses == start.size()";
+    c.clauses = c.clause_storage.data();
+    c.start = c.start_storage.data();
+    c.nlits = c.clause_storage.size();
+
+    // Build the inverse clause index: count occurrences of each literal,
+    // turn the counts into offsets by prefix summing, then fill each
+    // literal's group with a cursor copy of the offsets. Note: if a literal
+    // appears twice in a clause, the clause index will appear twice in its
+    // group.
+    c.invclause_offset_storage.assign(2 * c.nvars + 2, 0);
+    c.invclause_offset = &c.invclause_offset_storage[c.nvars];
+    for (clause_t j = 0; j < c.nlits; ++j) {
+        ++c.invclause_offset[c.clauses[j] + 1];
+    }
+    for (size_t j = 1; j < c.invclause_offset_storage.size(); ++j) {
+        c.invclause_offset_storage[j] += c.invclause_offset_storage[j - 1];
+    }
+    c.invclause_storage.resize(c.nlits);
+    c.invclause = c.invclause_storage.data();
+    std::vector<clause_t> cursor(c.invclause_offset_storage);
     for (clause_t i = 0; i < c.nclauses; ++i) {
         clause_t end = c.clause_end(i);
         for (clause_t j = c.clause_begin(i); j < end; ++j) {
-            // Note: if a literal appears twice in a clause, the clause index
-            // will appear twice in invclause.
-            c.invclause[c.clauses[j]].push_back(i);
+            c.invclause[cursor[c.clauses[j] + c.nvars]++] = i;
         }
     }
 
     return c;
 }
 
+// Flips the variable underlying choice and repairs numtrue, tsum, cost, and
+// the unsat stack for every clause containing it. This is the incremental
+// bookkeeping of step W5, shared by the flip loop and by warm restarts.
+void flip_lit(Cnf* c, lit_t choice) {
+    lit_t pos = (c->val[var(choice)] == (choice > 0)) ? choice : -choice;
+    lit_t neg = -pos;
+
+    c->val[var(choice)] = !c->val[var(choice)];
+
+    // Iterate over all clauses where choice was true but is now false.
+    clause_t pend = c->invclause_end(pos);
+    for (clause_t pitr = c->invclause_begin(pos); pitr < pend; ++pitr) {
+        clause_t i = c->invclause[pitr];
+        --c->numtrue[i];
+        c->tsum[i] -= pos;
+        if (c->numtrue[i] == 0) {
+            // Clause is newly unsatisfied.
+            c->register_unsatisfied(i);
+            --c->cost[var(choice)];
+        } else if (c->numtrue[i] == 1) {
+            // Some other variable in the clause needs its cost incremented.
+            if (PARAM_prob_sat) {
+                // tsum now holds the one remaining true literal. The
+                // is_true check mirrors the scan below when a duplicated
+                // literal leaves a stale occurrence of pos in tsum.
+                lit_t crit = static_cast<lit_t>(c->tsum[i]);
+                if (c->is_true(crit)) ++c->cost[var(crit)];
+                continue;
+            }
+            clause_t end = c->clause_end(i);
+            clause_t begin = c->clause_begin(i);
+            for (clause_t itr = begin; itr < end; ++itr) {
+                if (c->is_true(c->clauses[itr])) {
+                    ++c->cost[var(c->clauses[itr])];
+                    if (PARAM_move_to_front) {
+                        std::swap(c->clauses[begin], c->clauses[itr]);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    // Iterate over all clauses where choice was false but is now true.
+    clause_t nend = c->invclause_end(neg);
+    for (clause_t nitr = c->invclause_begin(neg); nitr < nend; ++nitr) {
+        clause_t i = c->invclause[nitr];
+        ++c->numtrue[i];
+        c->tsum[i] += neg;
+        if (c->numtrue[i] == 1) {
+            // Clause is newly satisfied.
+            c->register_satisfied(i);
+            ++c->cost[var(choice)];
+        } else if (c->numtrue[i] == 2) {
+            // Some other variable in the clause needs its cost decremented.
+            if (PARAM_prob_sat) {
+                // tsum minus the literal just made true is the literal
+                // that was critical until now. The comparison with neg
+                // mirrors the scan below when the clause contains neg
+                // twice.
+                lit_t crit = static_cast<lit_t>(c->tsum[i] - neg);
+                if (crit != neg) --c->cost[var(crit)];
+                continue;
+            }
+            clause_t end = c->clause_end(i);
+            for (clause_t itr = c->clause_begin(i); itr < end; ++itr) {
+                if (c->clauses[itr] != neg && c->is_true(c->clauses[itr])) {
+                    --c->cost[var(c->clauses[itr])];
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Warm restart (a partial W1): instead of discarding the whole assignment at
+// the start of an epoch, flip warm_restart_frac of the variables -- each
+// drawn from a random unsatisfied clause with probability
+// warm_restart_unsat_bias and uniformly otherwise -- and let flip_lit repair
+// the clause bookkeeping for just the clauses they touch. This keeps the
+// restart cost proportional to the perturbation instead of the formula and
+// preserves progress from earlier epochs.
+void perturb(Cnf* c) {
+    CHECK_NO_OVERFLOW(clause_t, RAND_MAX);
+    size_t target = std::max(static_cast<size_t>(1),
+        static_cast<size_t>(PARAM_warm_restart_frac * c->nvars));
+    for (size_t i = 0; i < target; ++i) {
+        lit_t v = lit_nil;
+        if (!c->unsat.empty() && flip(PARAM_warm_restart_unsat_bias)) {
+            clause_t divisor =
+                (static_cast<clause_t>(RAND_MAX) + 1)/c->unsat.size();
+            clause_t q;
+            do { q = rand_r(&rng_state) / divisor; } while
+                (q >= c->unsat.size());
+            clause_t cl = c->unsat[q];
+            clause_t len = c->clause_end(cl) - c->clause_begin(cl);
+            clause_t ldiv = (static_cast<clause_t>(RAND_MAX) + 1)/len;
+            clause_t li;
+            do { li = rand_r(&rng_state) / ldiv; } while (li >= len);
+            v = var(c->clauses[c->clause_begin(cl) + li]);
+        } else {
+            clause_t nv = static_cast<clause_t>(c->nvars);
+            clause_t vdiv = (static_cast<clause_t>(RAND_MAX) + 1)/nv;
+            clause_t q;
+            do { q = rand_r(&rng_state) / vdiv; } while (q >= nv);
+            v = static_cast<lit_t>(q) + 1;
+        }
+        INC(perturbations);
+        flip_lit(c, v);
+    }
+}
+
 // Returns true exactly when a satisfying assignment exists for c after
-// random initialization and n iterations of WalkSAT.
-bool walk(Cnf* c, uint64_t n) {
+// initialization and n iterations of WalkSAT. The first epoch (and every
+// epoch, when warm restarts are disabled) starts from a fresh random
+// assignment; when warm is true the previous epoch's assignment is perturbed
+// in place instead.
+bool walk(Cnf* c, uint64_t n, bool warm) {
 
     // W1. [Initialize.]
-    c->unsat.clear();
-    for (lit_t i = 1; i <= c->nvars; ++i) {
-        c->val[i] = flip(PARAM_initial_bias);
-        c->cost[i] = 0;
-    }
+    if (warm) {
+        perturb(c);
+    } else {
+        c->unsat.clear();
+        for (lit_t i = 1; i <= c->nvars; ++i) {
+            c->val[i] = flip(PARAM_initial_bias);
+            c->cost[i] = 0;
+        }
 
-    for (clause_t i = 0; i < c->nclauses; ++i) {
-        c->numtrue[i] = 0;
-        c->unsat_index[i] = clause_nil;
-        clause_t end = c->clause_end(i);
-        lit_t tl = lit_nil;
-        for (clause_t j = c->clause_begin(i); j < end; ++j) {
-            if (c->is_true(c->clauses[j])) {
-                ++c->numtrue[i];
-                tl = var(c->clauses[j]);
+        for (clause_t i = 0; i < c->nclauses; ++i) {
+            c->numtrue[i] = 0;
+            c->tsum[i] = 0;
+            c->unsat_index[i] = clause_nil;
+            clause_t end = c->clause_end(i);
+            lit_t tl = lit_nil;
+            for (clause_t j = c->clause_begin(i); j < end; ++j) {
+                if (c->is_true(c->clauses[j])) {
+                    ++c->numtrue[i];
+                    c->tsum[i] += c->clauses[j];
+                    tl = var(c->clauses[j]);
+                }
+            }
+            if (c->numtrue[i] == 0) {
+                c->unsat_index[i] = c->unsat.size();
+                c->unsat.push_back(i);
+            } else if (c->numtrue[i] == 1) {
+                ++c->cost[tl];
             }
         }
-        if (c->numtrue[i] == 0) {
-            c->unsat_index[i] = c->unsat.size();
-            c->unsat.push_back(i);
-        } else if (c->numtrue[i] == 1) {
-            ++c->cost[tl];
+    }
+
+    // Weight table for probSAT-style flip selection: wtab[b] is the selection
+    // weight of a literal with break count b.
+    double wtab[kMaxWeightedBreak + 1];
+    if (PARAM_prob_sat) {
+        for (clause_t b = 0; b <= kMaxWeightedBreak; ++b) {
+            wtab[b] = pow(PARAM_prob_sat_cb, -static_cast<double>(b));
         }
     }
 
@@ -237,27 +478,44 @@ bool walk(Cnf* c, uint64_t n) {
         clause_t divisor =
             (static_cast<clause_t>(RAND_MAX) + 1)/c->unsat.size();
         clause_t q;
-        do { q = std::rand() / divisor; } while (q >= c->unsat.size());
+        do { q = rand_r(&rng_state) / divisor; } while (q >= c->unsat.size());
         LOG(2) << "Chose clause " << q << ": " << c->dump_clause(c->unsat[q]);
 
         // W4. [Choose l.]
-        bool all = flip(PARAM_non_greedy_choice);
         clause_t end = c->clause_end(c->unsat[q]);
         lit_t choice = lit_nil;
-        int k = 0;
-        clause_t min_cost = std::numeric_limits<clause_t>::max();
-        for (clause_t itr = c->clause_begin(c->unsat[q]); itr < end; ++itr) {
-            clause_t cost = c->cost[var(c->clauses[itr])];
-            CHECK(c->cost[var(c->clauses[itr])] >= 0)
-                << "Cost of " << var(c->clauses[itr]) << " is negative.";
-            LOG(3) << var(c->clauses[itr]) << " has cost " << cost;
-            if (cost < min_cost && (cost == 0 || all)) {
-                min_cost = cost;
-                k = 0;
+        if (PARAM_prob_sat) {
+            // Sample a literal with probability proportional to
+            // prob_sat_cb^-cost. Replacing the running choice with literal i
+            // with probability w_i/(w_1 + ... + w_i) selects each literal
+            // with the right final probability, just like the 1/k trick
+            // below.
+            double total = 0.0;
+            for (clause_t itr = c->clause_begin(c->unsat[q]); itr < end;
+                 ++itr) {
+                clause_t cost = c->cost[var(c->clauses[itr])];
+                double w = wtab[std::min(cost, kMaxWeightedBreak)];
+                total += w;
+                if (flip(w/total)) { choice = c->clauses[itr]; }
             }
-            if (cost <= min_cost) {
-                ++k;
-                if (flip(1.0/k)) { choice = c->clauses[itr]; }
+        } else {
+            bool all = flip(PARAM_non_greedy_choice);
+            int k = 0;
+            clause_t min_cost = std::numeric_limits<clause_t>::max();
+            for (clause_t itr = c->clause_begin(c->unsat[q]); itr < end;
+                 ++itr) {
+                clause_t cost = c->cost[var(c->clauses[itr])];
+                CHECK(c->cost[var(c->clauses[itr])] >= 0)
+                    << "Cost of " << var(c->clauses[itr]) << " is negative.";
+                LOG(3) << var(c->clauses[itr]) << " has cost " << cost;
+                if (cost < min_cost && (cost == 0 || all)) {
+                    min_cost = cost;
+                    k = 0;
+                }
+                if (cost <= min_cost) {
+                    ++k;
+                    if (flip(1.0/k)) { choice = c->clauses[itr]; }
+                }
             }
         }
         CHECK(choice != lit_nil) << "No flip literal chosen.";
@@ -266,52 +524,8 @@ bool walk(Cnf* c, uint64_t n) {
                << c->cost[var(choice)] << ")";
 
         // W5. [Flip l.]
-        lit_t pos = (c->val[var(choice)] == (choice > 0)) ? choice : -choice;
-        lit_t neg = -pos;
-
-        c->val[var(choice)] = !c->val[var(choice)];
-
-        // Iterate over all clauses where choice was true but is now false.
-        for (clause_t i : c->invclause[pos]) {
-            --c->numtrue[i];
-            if (c->numtrue[i] == 0) {
-                // Clause is newly unsatisfied.
-                c->register_unsatisfied(i);
-                --c->cost[var(choice)];
-            } else if (c->numtrue[i] == 1) {
-                // Some other variable in the clause needs its cost incremented.
-                clause_t end = c->clause_end(i);
-                clause_t begin = c->clause_begin(i);
-                for (clause_t itr = begin; itr < end; ++itr) {
-                    if (c->is_true(c->clauses[itr])) {
-                        ++c->cost[var(c->clauses[itr])];
-                        if (PARAM_move_to_front) {
-                            std::swap(c->clauses[begin], c->clauses[itr]);
-                        }
-                        break;
-                    }
-                }
-            }
-        }
-
-        // Iterate over all clauses where choice was false but is now true.
-        for (clause_t i : c->invclause[neg]) {
-            ++c->numtrue[i];
-            if (c->numtrue[i] == 1) {
-                // Clause is newly satisfied.
-                c->register_satisfied(i);
-                ++c->cost[var(choice)];
-            } else if (c->numtrue[i] == 2) {
-                // Some other variable in the clause needs its cost decremented.
-                clause_t end = c->clause_end(i);
-                for (clause_t itr = c->clause_begin(i); itr < end; ++itr) {
-                    if (c->clauses[itr] != neg && c->is_true(c->clauses[itr])) {
-                        --c->cost[var(c->clauses[itr])];
-                        break;
-                    }
-                }
-            }
-        }
+        INC(flips);
+        flip_lit(c, choice);
     }
     return false;
 }
@@ -327,10 +541,12 @@ void reluctant_double(uint64_t& u, uint64_t& v) {
 bool solve(Cnf* c) {
     uint64_t base = c->nvars;
     if (PARAM_quadratic_cutoff) base *= c->nvars;
+    bool warm = false;
     for (uint64_t u = 1, v = 1; true; reluctant_double(u, v)) {
         uint64_t iters = v * base * PARAM_cutoff_multiplier;
         LOG(1) << "Running for " << iters << " iterations.";
-        if (walk(c, iters)) return true;
+        if (walk(c, iters, warm)) return true;
+        warm = PARAM_warm_restart_frac > 0;
         INC(restarts);
     }
 }
@@ -343,5 +559,38 @@ int main(int argc, char** argv) {
     init_timers();
     Processor p(argv[oidx]);
     Cnf c = parse(&p);
-    if (c.clauses.empty() || solve(&c)) { SAT_EXIT(&c); }
+    if (c.clause_storage.empty()) { SAT_EXIT(&c); }
+
+    size_t walkers = PARAM_walk_threads;
+    if (walkers <= 1) {
+        if (solve(&c)) { SAT_EXIT(&c); }
+        return UNKNOWN;
+    }
+
+    // Multi-walker mode: run independent walkers over one shared copy of the
+    // formula, each with private search state and a different seed. The
+    // first walker to empty its unsat stack reports the result and exits the
+    // process.
+    if (PARAM_move_to_front) {
+        // move_to_front reorders the shared clause array.
+#ifdef BAKED_PARAMS
+        CHECK(false) << "Multi-walker mode needs move_to_front baked to 0.";
+#else
+        PRINT << "c move_to_front disabled in multi-walker mode." << std::endl;
+        PARAM_move_to_front = 0;
+#endif
+    }
+    std::vector<Cnf*> cs;
+    for (size_t i = 0; i < walkers; ++i) { cs.push_back(new Cnf(&c)); }
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < walkers; ++i) {
+        Cnf* ci = cs[i];
+        unsigned int seed = FLAGS_seed + i;
+        threads.emplace_back([ci, seed]{
+            rng_state = seed;
+            if (solve(ci)) SAT_EXIT(ci);
+        });
+    }
+    for (std::thread& t : threads) { t.join(); }
+    return UNKNOWN;
 }